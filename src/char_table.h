@@ -0,0 +1,123 @@
+#ifndef COMP6771_ASS2_CHAR_TABLE_H
+#define COMP6771_ASS2_CHAR_TABLE_H
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace fsv {
+	// A predicate over char stored as a 256-bit set, one bit per byte value.
+	// Since a filter only ever sees 256 distinct inputs, any predicate that is a pure
+	// function of its argument can be tabulated once and then evaluated without a call.
+	class char_table {
+	 public:
+		// keeps nothing
+		constexpr char_table() noexcept = default;
+
+		// Evaluates pred once for every byte value.
+		template<typename Pred>
+		requires (!std::same_as<std::remove_cvref_t<Pred>, char_table>) && std::predicate<const Pred &, const char &>
+		constexpr explicit char_table(const Pred &pred) {
+			for (int i = 0; i < 256; ++i) {
+				const auto c = static_cast<char>(static_cast<unsigned char>(i));
+				if (pred(c)) {
+					set(c);
+				}
+			}
+		}
+
+		constexpr auto operator()(const char &c) const noexcept -> bool {
+			return test(c);
+		}
+
+		[[nodiscard]] constexpr auto test(char c) const noexcept -> bool {
+			const auto u = static_cast<unsigned char>(c);
+			return ((bits_[u >> 6] >> (u & 63u)) & 1u) != 0;
+		}
+
+		constexpr auto set(char c, bool value = true) noexcept -> char_table & {
+			const auto u = static_cast<unsigned char>(c);
+			const auto bit_ = std::uint64_t{1} << (u & 63u);
+			bits_[u >> 6] = value ? (bits_[u >> 6] | bit_) : (bits_[u >> 6] & ~bit_);
+			return *this;
+		}
+
+		// number of byte values kept
+		[[nodiscard]] constexpr auto count() const noexcept -> std::size_t {
+			std::size_t res_ = 0;
+			for (auto word : bits_) {
+				res_ += static_cast<std::size_t>(std::popcount(word));
+			}
+			return res_;
+		}
+
+		// all() and none() sit in front of every kernel call, so they compare words rather than count
+		[[nodiscard]] constexpr auto all() const noexcept -> bool {
+			return (bits_[0] & bits_[1] & bits_[2] & bits_[3]) == ~std::uint64_t{0};
+		}
+
+		[[nodiscard]] constexpr auto none() const noexcept -> bool {
+			return (bits_[0] | bits_[1] | bits_[2] | bits_[3]) == 0;
+		}
+
+		// bit (u & 63) of words()[u >> 6] is set iff byte value u is kept
+		[[nodiscard]] constexpr auto words() const noexcept -> const std::array<std::uint64_t, 4> & {
+			return bits_;
+		}
+
+		// keeps the chars both tables keep
+		constexpr auto operator&=(const char_table &other) noexcept -> char_table & {
+			for (std::size_t i = 0; i < bits_.size(); ++i) {
+				bits_[i] &= other.bits_[i];
+			}
+			return *this;
+		}
+
+		// keeps the chars either table keeps
+		constexpr auto operator|=(const char_table &other) noexcept -> char_table & {
+			for (std::size_t i = 0; i < bits_.size(); ++i) {
+				bits_[i] |= other.bits_[i];
+			}
+			return *this;
+		}
+
+		// keeps the chars exactly one of the tables keeps
+		constexpr auto operator^=(const char_table &other) noexcept -> char_table & {
+			for (std::size_t i = 0; i < bits_.size(); ++i) {
+				bits_[i] ^= other.bits_[i];
+			}
+			return *this;
+		}
+
+		friend constexpr auto operator&(char_table lhs, const char_table &rhs) noexcept -> char_table {
+			return lhs &= rhs;
+		}
+
+		friend constexpr auto operator|(char_table lhs, const char_table &rhs) noexcept -> char_table {
+			return lhs |= rhs;
+		}
+
+		friend constexpr auto operator^(char_table lhs, const char_table &rhs) noexcept -> char_table {
+			return lhs ^= rhs;
+		}
+
+		// keeps the chars this table drops
+		constexpr auto operator~() const noexcept -> char_table {
+			auto res_ = *this;
+			for (auto &word : res_.bits_) {
+				word = ~word;
+			}
+			return res_;
+		}
+
+		friend constexpr auto operator==(const char_table &, const char_table &) -> bool = default;
+
+	 private:
+		std::array<std::uint64_t, 4> bits_{};
+	};
+}
+
+#endif // COMP6771_ASS2_CHAR_TABLE_H
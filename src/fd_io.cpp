@@ -0,0 +1,60 @@
+#include "./fd_io.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <system_error>
+
+#include <sys/uio.h>
+
+namespace fsv {
+	namespace {
+#ifdef IOV_MAX
+		constexpr std::size_t batch_size = std::min<std::size_t>(IOV_MAX, 1024);
+#else
+		constexpr std::size_t batch_size = 16; // the smallest IOV_MAX POSIX allows
+#endif
+
+		// writes all of iov[0, n), resuming after short writes; iov is consumed
+		auto write_all(int fd, iovec *iov, std::size_t n) -> void {
+			while (n > 0) {
+				const auto res_ = ::writev(fd, iov, static_cast<int>(n));
+				if (res_ < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throw std::system_error{errno, std::generic_category(), "fsv::write_to_fd"};
+				}
+				auto done_ = static_cast<std::size_t>(res_);
+				while (n > 0 && done_ >= iov->iov_len) {
+					done_ -= iov->iov_len;
+					++iov;
+					--n;
+				}
+				if (n > 0) {
+					iov->iov_base = static_cast<char *>(iov->iov_base) + done_;
+					iov->iov_len -= done_;
+				}
+			}
+		}
+	}
+
+	auto write_to_fd(int fd, const filtered_string_view &fsv) -> std::size_t {
+		FSV_STATS_SCOPE(write);
+		auto batch_ = std::array<iovec, batch_size>{};
+		std::size_t used_ = 0;
+		std::size_t res_ = 0;
+		for (auto run : fsv.runs()) {
+			// writev only reads through iov_base
+			batch_[used_++] = iovec{const_cast<char *>(run.data()), run.size()};
+			res_ += run.size();
+			if (used_ == batch_.size()) {
+				write_all(fd, batch_.data(), used_);
+				used_ = 0;
+			}
+		}
+		write_all(fd, batch_.data(), used_);
+		return res_;
+	}
+}
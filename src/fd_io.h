@@ -0,0 +1,18 @@
+#ifndef COMP6771_ASS2_FD_IO_H
+#define COMP6771_ASS2_FD_IO_H
+
+#include "./filtered_string_view.h"
+
+#include <cstddef>
+
+namespace fsv {
+	// Writes the kept chars of fsv to the file descriptor fd and returns how many there were.
+	// The runs of kept chars are handed to writev straight from the viewed buffer, up to
+	// IOV_MAX at a time, so nothing is copied; short writes are resumed and EINTR retried.
+	// Unlike operator<<, kept null chars are written like any other.
+	// Throws std::system_error if a write fails (including EAGAIN on a non-blocking fd, in
+	// which case an unknown prefix has been written).
+	auto write_to_fd(int fd, const filtered_string_view &fsv) -> std::size_t;
+}
+
+#endif // COMP6771_ASS2_FD_IO_H
@@ -0,0 +1,74 @@
+#include "./fd_io.h"
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+	// reads fd until end of file
+	auto read_all(int fd) -> std::string {
+		auto res = std::string{};
+		char buf[4096];
+		for (;;) {
+			const auto n = ::read(fd, buf, sizeof(buf));
+			if (n <= 0) {
+				return res;
+			}
+			res.append(buf, static_cast<std::size_t>(n));
+		}
+	}
+
+	// "a-a-a-...", so that every kept char is a run of its own
+	auto alternating(std::size_t n) -> std::string {
+		auto res = std::string{};
+		for (std::size_t i = 0; i < n; ++i) {
+			res += i % 2 == 0 ? static_cast<char>('a' + i % 26) : '-';
+		}
+		return res;
+	}
+}
+
+TEST_CASE("write_to_fd") {
+	auto not_dash = [](const char &c){ return c != '-'; };
+
+	SECTION("writes the kept chars to a file") {
+		// far more runs than fit in one writev
+		const auto s = alternating(20000);
+		auto *file = std::tmpfile();
+		REQUIRE(file != nullptr);
+		const auto sv = fsv::filtered_string_view{s, fsv::char_table{not_dash}};
+		REQUIRE(fsv::write_to_fd(::fileno(file), sv) == 10000);
+		REQUIRE(::lseek(::fileno(file), 0, SEEK_SET) == 0);
+		REQUIRE(read_all(::fileno(file)) == static_cast<std::string>(sv));
+		std::fclose(file);
+	}
+
+	SECTION("writes more than a pipe holds, and kept null chars") {
+		auto s = alternating(1 << 20) + std::string{"x\0y", 3};
+		int fds[2];
+		REQUIRE(::pipe(fds) == 0);
+		auto out = std::string{};
+		auto reader = std::thread{[&] { out = read_all(fds[0]); }};
+		const auto sv = fsv::filtered_string_view{s, not_dash};
+		const auto n = fsv::write_to_fd(fds[1], sv);
+		::close(fds[1]);
+		reader.join();
+		::close(fds[0]);
+		REQUIRE(n == sv.size());
+		REQUIRE(out == static_cast<std::string>(sv));
+		REQUIRE(out.substr(out.size() - 3) == std::string{"x\0y", 3});
+	}
+
+	SECTION("empty views write nothing") {
+		REQUIRE(fsv::write_to_fd(-1, fsv::filtered_string_view{}) == 0);
+		REQUIRE(fsv::write_to_fd(-1, fsv::filtered_string_view{"---", not_dash}) == 0);
+	}
+
+	SECTION("errors are thrown") {
+		REQUIRE_THROWS_AS(fsv::write_to_fd(-1, fsv::filtered_string_view{"abc"}), std::system_error);
+	}
+}
@@ -0,0 +1,109 @@
+#ifndef COMP6771_ASS2_FILTER_H
+#define COMP6771_ASS2_FILTER_H
+
+#include "./char_table.h"
+#include "./stats.h"
+
+#include <concepts>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace fsv {
+	// the "true" predicate: keeps every char
+	struct pass_through {
+		template<typename CharT>
+		constexpr auto operator()(const CharT &) const noexcept -> bool {
+			return true;
+		}
+	};
+
+	namespace detail {
+		inline constexpr char_table all_chars{pass_through{}};
+	}
+
+	// Type-erased char predicate with shared, immutable state.
+	// Copying a filter copies a reference-counted pointer, never the wrapped callable, so views
+	// and the tokens cut from them share one predicate. An empty filter keeps every char.
+	class filter {
+	 public:
+		filter() noexcept = default;
+
+		template<typename F>
+		requires (!std::same_as<std::remove_cvref_t<F>, filter>) && std::predicate<const std::decay_t<F> &, const char &>
+		filter(F &&f) { // implicit, like std::function
+			if constexpr (!std::is_same_v<std::decay_t<F>, pass_through>) {
+				state_ = std::make_shared<const holder<std::decay_t<F>>>(std::forward<F>(f));
+				stats::note_allocation();
+			}
+		}
+
+		auto operator()(const char &c) const -> bool {
+			stats::note_predicate_call();
+			return state_ == nullptr || state_->call(c);
+		}
+
+		// the wrapped callable if it is a T, nullptr otherwise
+		template<typename T>
+		[[nodiscard]] auto target() const noexcept -> const T * {
+			if constexpr (std::is_same_v<T, pass_through>) {
+				if (state_ == nullptr) {
+					return &keep_all_;
+				}
+			}
+			if (state_ != nullptr && *state_->type == typeid(T)) {
+				return static_cast<const T *>(state_->target);
+			}
+			return nullptr;
+		}
+
+		// the char_table behind the filter, or nullptr if it has to be called
+		[[nodiscard]] auto table() const noexcept -> const char_table * {
+			return state_ == nullptr ? &detail::all_chars : state_->table;
+		}
+
+		// Identifies the wrapped callable: copies of a filter share it, filters built separately
+		// do not. nullptr for an empty filter.
+		[[nodiscard]] auto id() const noexcept -> const void * {
+			return state_.get();
+		}
+
+	 private:
+		struct holder_base {
+			holder_base() = default;
+			holder_base(const holder_base &) = delete;
+			auto operator=(const holder_base &) -> holder_base & = delete;
+			virtual ~holder_base() = default;
+			[[nodiscard]] virtual auto call(const char &c) const -> bool = 0;
+
+			const std::type_info *type{nullptr};
+			const void *target{nullptr};
+			const char_table *table{nullptr}; // set when the callable is a char_table
+		};
+
+		template<typename F>
+		struct holder final : holder_base {
+			template<typename G>
+			explicit holder(G &&g) : f{std::forward<G>(g)} {
+				type = &typeid(F);
+				target = &f;
+				if constexpr (std::is_same_v<F, char_table>) {
+					table = &f;
+				}
+			}
+
+			[[nodiscard]] auto call(const char &c) const -> bool override {
+				return static_cast<bool>(f(c));
+			}
+
+			F f;
+		};
+
+		static constexpr pass_through keep_all_{};
+
+		std::shared_ptr<const holder_base> state_;
+	};
+}
+
+#endif // COMP6771_ASS2_FILTER_H
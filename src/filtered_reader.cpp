@@ -0,0 +1,111 @@
+#include "./filtered_reader.h"
+#include "./kernels.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <unistd.h>
+
+namespace fsv {
+	filtered_reader::filtered_reader(std::istream &in, filter pred, std::size_t block_size)
+	: in_{&in}, pred_{std::move(pred)}, block_size_{std::max<std::size_t>(block_size, 1)},
+	  raw_{new char[block_size_]}, kept_{new char[block_size_ + detail::compact_slack]} {}
+
+	filtered_reader::filtered_reader(int fd, filter pred, std::size_t block_size)
+	: fd_{fd}, pred_{std::move(pred)}, block_size_{std::max<std::size_t>(block_size, 1)},
+	  raw_{new char[block_size_]}, kept_{new char[block_size_ + detail::compact_slack]} {}
+
+	auto filtered_reader::fill_() -> std::size_t {
+		if (in_ != nullptr) {
+			// Like the fd path, wait only for the first char, then take whatever the stream
+			// buffer says it can hand out without waiting (its get area, or e.g. the bytes a filebuf
+			// finds ready in a pipe). A stream buffer that reports nothing (std::cin synced with
+			// stdio) therefore gives blocks of one char.
+			auto *buf_ = in_->rdbuf();
+			if (buf_ == nullptr || buf_->sgetn(raw_.get(), 1) != 1) {
+				in_->setstate(std::ios_base::eofbit);
+				return 0;
+			}
+			std::size_t n_ = 1;
+			while (n_ < block_size_) {
+				const auto avail_ = buf_->in_avail();
+				if (avail_ <= 0) {
+					break;
+				}
+				const auto want_ = std::min(static_cast<std::size_t>(avail_), block_size_ - n_);
+				const auto got_ = buf_->sgetn(raw_.get() + n_, static_cast<std::streamsize>(want_));
+				if (got_ <= 0) {
+					break;
+				}
+				n_ += static_cast<std::size_t>(got_);
+			}
+			return n_;
+		}
+		for (;;) {
+			// short reads (pipes, terminals) are handed on as they come rather than waited out
+			const auto res_ = ::read(fd_, raw_.get(), block_size_);
+			if (res_ >= 0) {
+				return static_cast<std::size_t>(res_);
+			}
+			if (errno != EINTR) {
+				throw std::system_error{errno, std::generic_category(), "fsv::filtered_reader: read"};
+			}
+		}
+	}
+
+	auto filtered_reader::next() -> std::string_view {
+		while (pending_.empty() && !at_end_) {
+			const auto n_ = fill_();
+			if (n_ == 0) {
+				at_end_ = true;
+				break;
+			}
+			const auto *table_ = pred_.table();
+			if (table_ != nullptr && table_->all()) {
+				pending_ = std::string_view{raw_.get(), n_};
+			}
+			else if (table_ != nullptr) {
+				pending_ = std::string_view{kept_.get(), detail::compact_kept(raw_.get(), n_, *table_, kept_.get())};
+			}
+			else {
+				std::size_t k = 0;
+				for (std::size_t i = 0; i < n_; ++i) {
+					kept_[k] = raw_[i];
+					k += pred_(raw_[i]) ? 1u : 0u;
+				}
+				pending_ = std::string_view{kept_.get(), k};
+			}
+		}
+		return std::exchange(pending_, std::string_view{});
+	}
+
+	auto filtered_reader::read(char *buf, std::size_t n) -> std::size_t {
+		std::size_t res_ = 0;
+		while (res_ < n) {
+			if (pending_.empty()) {
+				// only block for more input if nothing has been read yet
+				if (res_ > 0 || at_end_) {
+					break;
+				}
+				pending_ = next();
+				if (pending_.empty()) {
+					break;
+				}
+			}
+			const auto count_ = std::min(n - res_, pending_.size());
+			std::memcpy(buf + res_, pending_.data(), count_);
+			pending_.remove_prefix(count_);
+			res_ += count_;
+		}
+		return res_;
+	}
+
+	auto filtered_reader::eof() const noexcept -> bool {
+		return at_end_ && pending_.empty();
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef COMP6771_ASS2_FILTERED_READER_H
+#define COMP6771_ASS2_FILTERED_READER_H
+
+#include "./filter.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+namespace fsv {
+	// Filters a stream of unknown length a block at a time, in bounded memory.
+	// Raw data is pulled from an std::istream or a file descriptor in blocks of at most
+	// block_size bytes, each as much as has arrived once there is any, and the chars pred keeps
+	// are handed out either a block at a time (next) or into a caller's buffer (read).
+	// Table-backed filters are applied with the byte kernels, and a pass-through filter hands
+	// out the raw blocks without copying them. std::cin gives one-char blocks while it is
+	// synced with stdio; call std::ios::sync_with_stdio(false) before reading it in bulk.
+	// The source must outlive the reader, which does not close it.
+	class filtered_reader {
+	 public:
+		static constexpr std::size_t default_block_size = std::size_t{64} << 10;
+
+		explicit filtered_reader(std::istream &in, filter pred = {}, std::size_t block_size = default_block_size);
+		explicit filtered_reader(int fd, filter pred = {}, std::size_t block_size = default_block_size);
+
+		// The kept chars not yet handed out, at least one unless the input is exhausted; valid
+		// until the next call on the reader. Throws std::system_error if reading an fd fails, and
+		// passes on whatever the stream buffer throws.
+		[[nodiscard]] auto next() -> std::string_view;
+		// Copies up to n kept chars to buf and returns how many, 0 only once the input is
+		// exhausted. Waits for more input only while nothing has been copied.
+		auto read(char *buf, std::size_t n) -> std::size_t;
+		// whether the end of the input has been seen and every kept char handed out
+		[[nodiscard]] auto eof() const noexcept -> bool;
+
+	 private:
+		// reads the next raw block into raw_, returning its size; 0 at the end of the input
+		auto fill_() -> std::size_t;
+
+		std::istream *in_{nullptr};
+		int fd_{-1};
+		filter pred_;
+		std::size_t block_size_;
+		std::unique_ptr<char[]> raw_;
+		std::unique_ptr<char[]> kept_; // room for a block plus the compact kernels' slack
+		std::string_view pending_;     // kept chars of the current block not yet handed out
+		bool at_end_{false};           // the source is exhausted
+	};
+}
+
+#endif // COMP6771_ASS2_FILTERED_READER_H
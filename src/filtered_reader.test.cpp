@@ -0,0 +1,167 @@
+#include "./filtered_reader.h"
+#include "./filtered_string_view.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+	auto random_text(std::size_t n, unsigned seed) -> std::string {
+		auto gen = std::mt19937{seed};
+		auto res = std::string(n, ' ');
+		for (auto &c : res) {
+			c = "ab,- \n"[gen() % 6];
+		}
+		return res;
+	}
+
+	// hands its pieces out one underflow at a time, like a slowly fed pipe
+	struct trickle_buf : std::streambuf {
+		explicit trickle_buf(std::vector<std::string> p) : pieces{std::move(p)} {}
+
+		auto underflow() -> int_type override {
+			if (pulled == pieces.size()) {
+				return traits_type::eof();
+			}
+			auto &piece = pieces[pulled++];
+			setg(piece.data(), piece.data(), piece.data() + piece.size());
+			return traits_type::to_int_type(piece.front());
+		}
+
+		std::vector<std::string> pieces;
+		std::size_t pulled = 0;
+	};
+
+	// everything next() hands out, concatenated
+	auto drain(fsv::filtered_reader &reader) -> std::string {
+		auto res = std::string{};
+		for (auto block = reader.next(); !block.empty(); block = reader.next()) {
+			res += block;
+		}
+		return res;
+	}
+}
+
+TEST_CASE("filtered_reader") {
+	auto not_space = [](const char &c){ return c != ' ' && c != '\n'; };
+	const auto text = random_text(100000, 21);
+	const auto expected = static_cast<std::string>(fsv::filtered_string_view{text, not_space});
+
+	SECTION("next agrees with the in-memory view") {
+		for (const auto &pred : {fsv::filter{not_space}, fsv::filter{fsv::char_table{not_space}}}) {
+			for (auto block_size : {std::size_t{1}, std::size_t{100}, std::size_t{4096}, fsv::filtered_reader::default_block_size}) {
+				auto in = std::istringstream{text};
+				auto reader = fsv::filtered_reader{in, pred, block_size};
+				REQUIRE(drain(reader) == expected);
+				REQUIRE(reader.eof());
+				REQUIRE(reader.next().empty());
+			}
+		}
+	}
+
+	SECTION("pass-through filters hand out the input") {
+		auto in = std::istringstream{text};
+		auto reader = fsv::filtered_reader{in, {}, 1000};
+		REQUIRE(reader.next().size() == 1000);
+		REQUIRE(text.substr(1000) == drain(reader));
+	}
+
+	SECTION("blocks with nothing kept are skipped") {
+		auto in = std::istringstream{std::string(10000, ' ') + "x" + std::string(10000, ' ')};
+		auto reader = fsv::filtered_reader{in, not_space, 64};
+		REQUIRE(reader.next() == "x");
+		REQUIRE(reader.next().empty());
+		REQUIRE(reader.eof());
+	}
+
+	SECTION("read fills caller buffers of any size") {
+		auto in = std::istringstream{text};
+		auto reader = fsv::filtered_reader{in, fsv::char_table{not_space}, 1000};
+		auto gen = std::mt19937{22};
+		auto out = std::string{};
+		char buf[3000];
+		for (;;) {
+			const auto n = reader.read(buf, gen() % sizeof(buf) + 1);
+			if (n == 0) {
+				break;
+			}
+			out.append(buf, n);
+		}
+		REQUIRE(out == expected);
+		REQUIRE(reader.eof());
+	}
+
+	SECTION("read and next share their position") {
+		auto in = std::istringstream{"a b c d e f"};
+		auto reader = fsv::filtered_reader{in, not_space, 4};
+		char buf[1];
+		REQUIRE(reader.read(buf, 1) == 1);
+		REQUIRE(buf[0] == 'a');
+		REQUIRE(reader.next() == "b");
+		REQUIRE(drain(reader) == "cdef");
+	}
+
+	SECTION("streams hand on what has arrived without waiting for a full block") {
+		auto buf = trickle_buf{{"ab c", "d", " ef\n"}};
+		auto in = std::istream{&buf};
+		auto reader = fsv::filtered_reader{in, not_space};
+		REQUIRE(reader.next() == "abc");
+		REQUIRE(buf.pulled == 1);
+		char out[16];
+		REQUIRE(reader.read(out, sizeof(out)) == 1);
+		REQUIRE(out[0] == 'd');
+		REQUIRE(buf.pulled == 2);
+		REQUIRE(reader.next() == "ef");
+		REQUIRE(reader.next().empty());
+		REQUIRE(reader.eof());
+		REQUIRE(in.eof());
+	}
+
+	SECTION("buffered streams are read up to a block at a time") {
+		auto in = std::istringstream{text.substr(0, 10000)};
+		auto reader = fsv::filtered_reader{in, {}, 4096};
+		auto sizes = std::vector<std::size_t>{};
+		for (auto block = reader.next(); !block.empty(); block = reader.next()) {
+			sizes.push_back(block.size());
+		}
+		REQUIRE(sizes == std::vector<std::size_t>{4096, 4096, 1808});
+		REQUIRE(reader.eof());
+	}
+
+	SECTION("file descriptors") {
+		int fds[2];
+		REQUIRE(::pipe(fds) == 0);
+		// small writes, so the reader sees short reads
+		auto written = true;
+		auto writer = std::thread{[&] {
+			for (std::size_t i = 0; i < text.size(); i += 777) {
+				const auto n = std::min<std::size_t>(777, text.size() - i);
+				written = written && ::write(fds[1], text.data() + i, n) == static_cast<ssize_t>(n);
+			}
+			::close(fds[1]);
+		}};
+		auto reader = fsv::filtered_reader{fds[0], fsv::char_table{not_space}};
+		const auto out = drain(reader);
+		writer.join();
+		::close(fds[0]);
+		REQUIRE(written);
+		REQUIRE(out == expected);
+	}
+
+	SECTION("empty input") {
+		auto in = std::istringstream{};
+		auto reader = fsv::filtered_reader{in};
+		REQUIRE(reader.next().empty());
+		REQUIRE(reader.eof());
+		char buf[1];
+		REQUIRE(reader.read(buf, 1) == 0);
+	}
+}
@@ -0,0 +1,269 @@
+// Microbenchmarks for filtered_string_view operations.
+// Every operation is timed over a range of input sizes, predicate selectivities and
+// predicate kinds, and the results are written to stdout as JSON, e.g.
+//   ./filtered_string_view_bench --max-bytes=16777216 --min-time=0.2 > results.json
+// Where the kernel allows it, hardware counters (cycles, instructions, branch and cache
+// misses) are collected over the same runs and reported per call and per byte.
+#include "./filtered_string_view.h"
+#include "./kernels.h"
+#include "./parallel.h"
+#include "./perf_counters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	struct options {
+		std::size_t min_bytes = 64;
+		std::size_t max_bytes = std::size_t{256} << 20;
+		double min_time = 0.1; // seconds spent on each measurement, at least
+		std::string only;      // run only the operation with this name when set
+	};
+
+	struct result {
+		std::string op;
+		std::string predicate;
+		double selectivity;
+		std::size_t bytes;
+		std::uint64_t iterations;
+		double seconds;
+		fsv::bench::perf_counters::values counters;
+	};
+
+	struct measurement {
+		std::uint64_t iterations;
+		double seconds;
+		fsv::bench::perf_counters::values counters;
+	};
+
+	// keeps the compiler from discarding a result
+	template<typename T>
+	auto do_not_optimize(const T &value) -> void {
+		asm volatile("" : : "m"(value) : "memory");
+	}
+
+	// Runs op in batches of growing size until min_time has passed.
+	auto measure(const options &opts, fsv::bench::perf_counters &counters, const std::function<void()> &op) -> measurement {
+		using clock = std::chrono::steady_clock;
+		std::uint64_t iterations_ = 0;
+		std::uint64_t batch_ = 1;
+		op(); // warm up caches and the kernel dispatch
+		counters.start();
+		const auto start_ = clock::now();
+		for (;;) {
+			for (std::uint64_t i = 0; i < batch_; ++i) {
+				op();
+			}
+			iterations_ += batch_;
+			const auto elapsed_ = std::chrono::duration<double>(clock::now() - start_).count();
+			if (elapsed_ >= opts.min_time) {
+				counters.stop();
+				return {iterations_, elapsed_, counters.read()};
+			}
+			batch_ *= 2;
+		}
+	}
+
+	// a stream buffer that drops everything, so "write" times operator<< rather than the sink
+	struct null_buf : std::streambuf {
+		auto xsputn(const char *, std::streamsize n) -> std::streamsize override {
+			return n;
+		}
+		auto overflow(int_type c) -> int_type override {
+			return traits_type::not_eof(c);
+		}
+	};
+
+	// Random bytes with a ',' roughly every 64 bytes, so split produces many short tokens.
+	auto make_input(std::size_t n) -> std::string {
+		auto gen_ = std::mt19937_64{n};
+		auto res_ = std::string(n, '\0');
+		for (std::size_t i = 0; i < n; i += 8) {
+			auto word_ = gen_();
+			for (std::size_t j = i; j < n && j < i + 8; ++j) {
+				res_[j] = static_cast<char>(word_ & 0xffu);
+				word_ >>= 8;
+			}
+		}
+		for (std::size_t i = 63; i < n; i += 64) {
+			res_[i] = ',';
+		}
+		return res_;
+	}
+
+	// Keeps ',' and about `selectivity` of all other byte values.
+	auto make_lambda(double selectivity) -> fsv::filter {
+		const auto limit_ = static_cast<unsigned>(selectivity * 256.0);
+		return [limit_](const char &c) { return c == ',' || static_cast<unsigned char>(c) < limit_; };
+	}
+
+	auto make_table(double selectivity) -> fsv::filter {
+		return fsv::char_table{make_lambda(selectivity)};
+	}
+
+	auto json_string(std::string_view s) -> std::string {
+		auto res_ = std::string{"\""};
+		for (auto c : s) {
+			if (c == '"' || c == '\\') {
+				res_ += '\\';
+			}
+			res_ += c;
+		}
+		return res_ + "\"";
+	}
+
+	auto isa_name(fsv::detail::isa level) -> std::string_view {
+		switch (level) {
+		case fsv::detail::isa::scalar: return "scalar";
+		case fsv::detail::isa::ssse3: return "ssse3";
+		case fsv::detail::isa::avx2: return "avx2";
+		case fsv::detail::isa::avx512bw: return "avx512bw";
+		case fsv::detail::isa::avx512vbmi2: return "avx512vbmi2";
+		}
+		return "unknown";
+	}
+
+	auto write_json(std::ostream &os, const fsv::bench::perf_counters &counters, const std::vector<result> &results) -> void {
+		os << "{\n  \"context\": {\"isa\": " << json_string(isa_name(fsv::detail::best_isa()))
+		   << ", \"compiler\": " << json_string(__VERSION__)
+		   << ", \"counters_available\": " << (counters.available() ? "true" : "false")
+		   << ", \"counters_error\": " << json_string(counters.error()) << "},\n  \"benchmarks\": [";
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			const auto &r = results[i];
+			const auto per_op_ = r.seconds * 1e9 / static_cast<double>(r.iterations);
+			os << (i == 0 ? "\n" : ",\n") << "    {\"op\": " << json_string(r.op)
+			   << ", \"predicate\": " << json_string(r.predicate)
+			   << ", \"selectivity\": " << r.selectivity
+			   << ", \"bytes\": " << r.bytes
+			   << ", \"iterations\": " << r.iterations
+			   << ", \"ns_per_op\": " << per_op_
+			   << ", \"ns_per_byte\": " << per_op_ / static_cast<double>(r.bytes)
+			   << ", \"counters\": {";
+			auto first_ = true;
+			for (std::size_t c = 0; c < fsv::bench::counter_count; ++c) {
+				if (!r.counters[c]) {
+					continue;
+				}
+				const auto counter_per_op_ = *r.counters[c] / static_cast<double>(r.iterations);
+				os << (first_ ? "" : ", ") << json_string(fsv::bench::counter_name(static_cast<fsv::bench::counter>(c)))
+				   << ": {\"per_op\": " << counter_per_op_
+				   << ", \"per_byte\": " << counter_per_op_ / static_cast<double>(r.bytes) << "}";
+				first_ = false;
+			}
+			os << "}}";
+		}
+		os << "\n  ]\n}\n";
+	}
+
+	auto parse_options(int argc, char **argv) -> options {
+		auto res_ = options{};
+		for (int i = 1; i < argc; ++i) {
+			const auto arg_ = std::string_view{argv[i]};
+			const auto value_ = [&arg_](std::string_view flag) -> const char * {
+				return arg_.starts_with(flag) ? arg_.data() + flag.size() : nullptr;
+			};
+			if (const auto *v = value_("--min-bytes=")) {
+				res_.min_bytes = std::strtoull(v, nullptr, 10);
+			}
+			else if (const auto *v = value_("--max-bytes=")) {
+				res_.max_bytes = std::strtoull(v, nullptr, 10);
+			}
+			else if (const auto *v = value_("--min-time=")) {
+				res_.min_time = std::strtod(v, nullptr);
+			}
+			else if (const auto *v = value_("--only=")) {
+				res_.only = v;
+			}
+			else {
+				std::cerr << "usage: " << argv[0] << " [--min-bytes=N] [--max-bytes=N] [--min-time=SECONDS] [--only=OP]\n";
+				std::exit(2);
+			}
+		}
+		return res_;
+	}
+}
+
+auto main(int argc, char **argv) -> int {
+	const auto opts = parse_options(argc, argv);
+	auto results = std::vector<result>{};
+	// opened before fsv::par::thread_pool::shared() starts its workers, so that the par_* ops
+	// are counted on every thread they run on
+	auto counters = fsv::bench::perf_counters{};
+	if (!counters.error().empty()) {
+		std::cerr << "hardware counters unavailable: " << counters.error() << '\n';
+	}
+
+	// sizes grow 16x at a time, the last step clamped so that max_bytes itself is always measured
+	const auto next_size = [&opts](std::size_t bytes) {
+		return bytes == opts.max_bytes ? opts.max_bytes + 1 : std::min(bytes * 16, opts.max_bytes);
+	};
+	for (auto bytes = opts.min_bytes; bytes <= opts.max_bytes; bytes = next_size(bytes)) {
+		const auto input = make_input(bytes);
+		const auto copy = input;
+		for (auto selectivity : {1.0, 0.5, 0.1}) {
+			for (const auto &[kind, pred] : {std::pair{"lambda", make_lambda(selectivity)}, std::pair{"table", make_table(selectivity)}}) {
+				const auto sv = fsv::filtered_string_view{input.data(), input.size(), pred};
+				const auto other = fsv::filtered_string_view{copy.data(), copy.size(), pred};
+				const auto size = sv.size();
+				const auto mid = static_cast<int>(size / 2);
+				const auto extra = std::vector<std::function<bool(const char &)>>{
+					[](const char &c) { return c != '\0'; },
+					fsv::char_table{[](const char &c) { return c != '\n'; }},
+				};
+
+				const auto ops = std::vector<std::pair<std::string, std::function<void()>>>{
+					{"construct", [&] { do_not_optimize(fsv::filtered_string_view{input.data(), input.size(), pred}); }},
+					{"size", [&] { do_not_optimize(sv.size()); }},
+					{"at", [&] { do_not_optimize(size == 0 ? '\0' : sv.at(mid)); }},
+					{"iterate", [&] {
+						unsigned sum_ = 0;
+						for (auto c : sv) {
+							sum_ += static_cast<unsigned char>(c);
+						}
+						do_not_optimize(sum_);
+					}},
+					{"to_string", [&] { do_not_optimize(static_cast<std::string>(sv).size()); }},
+					{"par_size", [&] { do_not_optimize(fsv::par::size(sv)); }},
+					{"par_to_string", [&] { do_not_optimize(fsv::par::to_string(sv).size()); }},
+					{"runs", [&] {
+						std::size_t kept_ = 0;
+						for (auto run : sv.runs()) {
+							kept_ += run.size();
+						}
+						do_not_optimize(kept_);
+					}},
+					{"write", [&] {
+						auto buf_ = null_buf{};
+						auto os_ = std::ostream{&buf_};
+						os_ << sv;
+					}},
+					{"split", [&] { do_not_optimize(fsv::split(sv, fsv::filtered_string_view{","}).size()); }},
+					{"par_split", [&] { do_not_optimize(fsv::par::split(sv, fsv::filtered_string_view{","}).size()); }},
+					{"substr", [&] { do_not_optimize(size == 0 ? fsv::filtered_string_view{} : fsv::substr(sv, mid / 2, mid)); }},
+					{"compose", [&] { do_not_optimize(fsv::compose(sv, extra)); }},
+					{"equal", [&] { do_not_optimize(sv == other); }},
+					{"compare", [&] { do_not_optimize(sv <=> other); }},
+				};
+				for (const auto &[name, op] : ops) {
+					if (!opts.only.empty() && name != opts.only) {
+						continue;
+					}
+					const auto m = measure(opts, counters, op);
+					results.push_back({name, kind, selectivity, bytes, m.iterations, m.seconds, m.counters});
+					std::cerr << name << ' ' << kind << ' ' << selectivity << ' ' << bytes << '\n';
+				}
+			}
+		}
+	}
+	write_json(std::cout, counters, results);
+}
@@ -1,113 +1,947 @@
 #ifndef COMP6771_ASS2_FSV_H
 #define COMP6771_ASS2_FSV_H
 
+#include "./char_table.h"
+#include "./filter.h"
+#include "./kernels.h"
+#include "./stats.h"
+
+#include <algorithm>
 #include <compare>
+#include <concepts>
+#include <cstring>
 #include <exception>
 #include <functional>
 #include <iterator>
+#include <ranges>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <iostream>
 
 namespace fsv {
-	using filter = std::function<bool(const char &)>;
+	namespace detail {
+		// The byte table behind pred, or nullptr if pred has to be called.
+		// For type-erased predicates this is a runtime check of the stored target.
+		template<typename Pred>
+		constexpr auto table_of(const Pred &pred) noexcept -> const char_table * {
+			if constexpr (std::is_same_v<Pred, char_table>) {
+				return &pred;
+			}
+			else if constexpr (std::is_same_v<Pred, filter>) {
+				return pred.table();
+			}
+			else {
+				return nullptr;
+			}
+		}
+
+		// whether pred is known to keep every char, so the view is its raw data
+		template<typename Pred>
+		constexpr auto is_pass_through(const Pred &pred) noexcept -> bool {
+			if constexpr (std::is_same_v<Pred, pass_through>) {
+				return true;
+			}
+			else if constexpr (std::is_same_v<Pred, char_table>) {
+				return pred.all();
+			}
+			else if constexpr (std::is_same_v<Pred, filter>) {
+				const auto *table_ = table_of(pred);
+				return table_ != nullptr && table_->all();
+			}
+			else {
+				return false;
+			}
+		}
+
+		// Calls f with the char_table behind pred when it has one, with pred itself otherwise.
+		// With stats enabled, called predicates are wrapped so that each call is counted
+		// (filter counts its own calls).
+		template<typename CharT, typename Pred, typename F>
+		constexpr auto visit_predicate(const Pred &pred, F &&f) -> decltype(auto) {
+			if constexpr (std::is_same_v<CharT, char> && !std::is_same_v<Pred, char_table>) {
+				if (const auto *table_ = table_of(pred)) {
+					return f(*table_);
+				}
+			}
+			if constexpr (stats::enabled && !std::is_same_v<Pred, char_table> && !std::is_same_v<Pred, filter>) {
+				if (!std::is_constant_evaluated()) {
+					return f(stats::detail::counted<Pred>{pred});
+				}
+			}
+			return f(pred);
+		}
+
+		// whether a predicate handed out by visit_predicate_ can go through the byte kernels
+		template<typename CharT, typename P>
+		inline constexpr bool uses_kernels_v = std::is_same_v<CharT, char> && std::is_same_v<std::remove_cvref_t<P>, char_table>;
+
+		// Calls on_match with the offset of each non-overlapping occurrence of delim in [ptr, ptr + len),
+		// found with Boyer-Moore-Horspool. Not constexpr, the searcher is not a literal type.
+		template<typename CharT, typename F>
+		auto for_each_match(const CharT *ptr, std::size_t len, const std::basic_string<CharT> &delim, F &&on_match) -> void {
+			const auto searcher_ = std::boyer_moore_horspool_searcher{delim.begin(), delim.end()};
+			for (auto pos_ = std::size_t{0};;) {
+				const auto *hit_ = searcher_(ptr + pos_, ptr + len).first;
+				if (hit_ == ptr + len) {
+					return;
+				}
+				pos_ = static_cast<std::size_t>(hit_ - ptr);
+				on_match(pos_);
+				pos_ += delim.size();
+			}
+		}
+
+		// Writes the KMP failure table of [delim, delim + m) to out: entry i is the length of the
+		// longest proper prefix of delim[0, i] that is also a suffix of it.
+		template<typename CharT>
+		constexpr auto kmp_failure(const CharT *delim, std::size_t m, std::size_t *out) noexcept -> void {
+			if (m == 0) {
+				return;
+			}
+			out[0] = 0;
+			for (std::size_t i = 1, k = 0; i < m; ++i) {
+				while (k > 0 && delim[i] != delim[k]) {
+					k = out[k - 1];
+				}
+				if (delim[i] == delim[k]) {
+					++k;
+				}
+				out[i] = k;
+			}
+		}
+
+		template<typename CharT>
+		constexpr auto kmp_failure(const std::basic_string<CharT> &delim) -> std::vector<std::size_t> {
+			auto res_ = std::vector<std::size_t>(delim.size(), 0);
+			kmp_failure(delim.data(), delim.size(), res_.data());
+			return res_;
+		}
+
+		// {raw offset of the first char at or after from kept by pred, raw offset just past the
+		// run of kept chars it starts}; {len, len} if there is none. pred is a predicate handed
+		// out by visit_predicate; tables find both ends of the run with the byte kernels.
+		template<typename CharT, typename P>
+		constexpr auto next_run(const CharT *ptr, std::size_t len, std::size_t from, const P &pred)
+		    -> std::pair<std::size_t, std::size_t> {
+			if constexpr (uses_kernels_v<CharT, P>) {
+				if (!std::is_constant_evaluated()) {
+					// gaps and runs of a single char are common enough to test for before calling a kernel
+					auto first_ = from;
+					if (first_ < len && (stats::note_bytes_scanned(1), !pred.test(ptr[first_]))) {
+						first_ += find_kept(ptr + first_, len - first_, pred);
+					}
+					if (first_ == len) {
+						return {len, len};
+					}
+					auto last_ = first_ + 1;
+					if (last_ < len && (stats::note_bytes_scanned(1), pred.test(ptr[last_]))) {
+						last_ += find_not_kept(ptr + last_, len - last_, pred);
+					}
+					return {first_, last_};
+				}
+			}
+			while (from < len && !pred(ptr[from])) {
+				++from;
+			}
+			auto last_ = from;
+			while (last_ < len && pred(ptr[last_])) {
+				++last_;
+			}
+			return {from, last_};
+		}
+
+		// Calls on_run(run, n) for each maximal run of chars in [ptr, ptr + len) kept by pred, in
+		// order, until it returns false.
+		template<typename CharT, typename P, typename F>
+		constexpr auto for_each_run(const CharT *ptr, std::size_t len, const P &pred, F &&on_run) -> void {
+			auto [first_, last_] = next_run(ptr, len, 0, pred);
+			while (first_ < len) {
+				if (!on_run(ptr + first_, last_ - first_)) {
+					return;
+				}
+				std::tie(first_, last_) = next_run(ptr, len, last_, pred);
+			}
+		}
+
+		[[noreturn]] inline auto throw_invalid_index(int n) -> void {
+			std::string err_msg = "filtered_string_view::at(" + std::to_string(n) + "): invalid index";
+			throw std::domain_error{err_msg.c_str()};
+		}
+	}
+
+	// A read-only view of CharT data with the chars for which Pred returns false filtered out.
+	// Pred is stored by value and called directly, so lambdas and function objects are inlined
+	// into the scanning loops; filtered_string_view below is the type-erased form using filter.
+	// With a literal Pred (a char_table, a capture-less lambda) views can be built, sized,
+	// compared, split and converted during constant evaluation, which skips the kernels.
+	template<typename CharT, typename Pred = std::conditional_t<std::is_same_v<CharT, char>, filter, std::function<bool(const CharT &)>>>
+	class basic_filtered_string_view {
+		static_assert(std::predicate<const Pred &, const CharT &>, "Pred must be callable as bool(const CharT &)");
 
-	//default predicate
-	class filtered_string_view {
 		class iter {
 		 public:
-			using MEMBER_TYPEDEFS_GO_HERE = void;
-
 			using difference_type = std::ptrdiff_t;
-			using value_type = char;
+			using value_type = CharT;
 			using pointer = void;
-			using reference = const char &;
+			using reference = const CharT &;
 			using iterator_category = std::bidirectional_iterator_tag;
 
-			iter();
-			iter(const char *p, const filter& pred, const std::size_t len, bool ending = false) noexcept;
+			iter() = default;
+			// begin iterators scan up to the first kept char; end iterators sit on the raw end
+			constexpr iter(const CharT *ptr, const Pred &pred, std::size_t len, bool ending = false) noexcept;
 
-			auto operator*() const -> reference; // change this
-			auto operator->() const -> pointer; // change this
+			constexpr auto operator*() const -> reference;
+			auto operator->() const -> pointer;
 
-			auto operator++() -> iter&;
-			auto operator++(int) -> iter;
-			auto operator--() -> iter&;
-			auto operator--(int) -> iter;
+			constexpr auto operator++() -> iter&;
+			constexpr auto operator++(int) -> iter;
+			constexpr auto operator--() -> iter&;
+			constexpr auto operator--(int) -> iter;
 
-			friend auto operator==(const iter &, const iter &) -> bool;
-			friend auto operator!=(const iter &, const iter &) -> bool;
+			friend constexpr auto operator==(const iter &lhs, const iter &rhs) -> bool {
+				return lhs.iter_ptr_ == rhs.iter_ptr_;
+			}
 
 		 private:
-			/* Implementation-specific private members */
-			char *iter_ptr_{nullptr};
-			const char *begin_{nullptr};
-			const char *end_{nullptr};
-			filter& pred_{default_predicate};
+			[[nodiscard]] constexpr auto keep_(CharT c) const -> bool;
+
+			const CharT *iter_ptr_{nullptr}; // current kept char, or end_
+			const CharT *begin_{nullptr};
+			const CharT *end_{nullptr}; // one past the raw data
+			// a copy, so that iterators stay valid after their view is gone or reassigned; for a
+			// filter this only shares its handle
+			Pred pred_{};
 		};
+
+		// Forward range over the maximal runs of kept chars, each a contiguous span of the raw
+		// data, found one at a time as the range is walked.
+		class run_range : public std::ranges::view_interface<run_range> {
+			class run_iter {
+			 public:
+				using value_type = std::basic_string_view<CharT>;
+				using difference_type = std::ptrdiff_t;
+				using reference = value_type;
+				using iterator_category = std::input_iterator_tag; // runs are made on dereference
+				using iterator_concept = std::forward_iterator_tag;
+
+				run_iter() = default;
+				// the first run starting at or after raw offset from
+				constexpr run_iter(const basic_filtered_string_view *fsv, std::size_t from);
+
+				constexpr auto operator*() const -> reference;
+
+				constexpr auto operator++() -> run_iter&;
+				constexpr auto operator++(int) -> run_iter;
+
+				friend constexpr auto operator==(const run_iter &lhs, const run_iter &rhs) -> bool {
+					return lhs.first_ == rhs.first_;
+				}
+
+			 private:
+				const basic_filtered_string_view *fsv_{nullptr};
+				std::size_t first_{0}; // raw offset of the current run, or raw_size() at the end
+				std::size_t last_{0};  // raw offset just past it
+			};
+
+		 public:
+			run_range() = default;
+			constexpr explicit run_range(const basic_filtered_string_view *fsv) noexcept : fsv_{fsv} {}
+
+			[[nodiscard]] constexpr auto begin() const -> run_iter {
+				return run_iter{fsv_, 0};
+			}
+			[[nodiscard]] constexpr auto end() const -> run_iter {
+				return run_iter{fsv_, fsv_->len_};
+			}
+
+		 private:
+			const basic_filtered_string_view *fsv_{nullptr};
+		};
+
 	 public:
-		static filter default_predicate;
+		static constexpr pass_through default_predicate{};
+		using value_type = CharT;
+		using predicate_type = Pred;
+		using string_type = std::basic_string<CharT>;
 		using iterator = iter;
 		using const_iterator = iter;	// filtered_string_view is immutable
 		using reverse_iterator = std::reverse_iterator<iter>;
 		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 		//Range member function
-		iterator begin() const noexcept;
-		iterator end() const noexcept;
-		[[nodiscard]] const_iterator cbegin() const noexcept;
-		[[nodiscard]] const_iterator cend() const noexcept;
-
-		reverse_iterator rbegin() const noexcept;
-		reverse_iterator rend() const noexcept;
-		[[nodiscard]] const_reverse_iterator crbegin() const noexcept;
-		[[nodiscard]] const_reverse_iterator crend() const noexcept;
+		constexpr iterator begin() const noexcept;
+		constexpr iterator end() const noexcept;
+		[[nodiscard]] constexpr const_iterator cbegin() const noexcept;
+		[[nodiscard]] constexpr const_iterator cend() const noexcept;
 
+		constexpr reverse_iterator rbegin() const noexcept;
+		constexpr reverse_iterator rend() const noexcept;
+		[[nodiscard]] constexpr const_reverse_iterator crbegin() const noexcept;
+		[[nodiscard]] constexpr const_reverse_iterator crend() const noexcept;
 
 		// constructor && destructor
-		explicit filtered_string_view() noexcept; // default constructors
-		filtered_string_view(const std::string &str) noexcept; // implicit string constructor
-		explicit filtered_string_view(const std::string &str, filter predicate) noexcept; // predicate constructor
-		filtered_string_view(const char *str) noexcept; // implicit Null-terminated string constructor
-		explicit filtered_string_view(const char *str, filter predicate) noexcept; // Null-terminated constructor
-		filtered_string_view(const filtered_string_view &other) noexcept; //Copy constructor
-		filtered_string_view(filtered_string_view &&other) noexcept; // Move constructor
+		// constructors without a predicate need Pred to be constructible from the "true" predicate
+		constexpr explicit basic_filtered_string_view() noexcept
+		requires std::constructible_from<Pred, pass_through>; // default constructors
+		constexpr basic_filtered_string_view(const string_type &str) noexcept
+		requires std::constructible_from<Pred, pass_through>; // implicit string constructor
+		constexpr explicit basic_filtered_string_view(const string_type &str, Pred predicate) noexcept; // predicate constructor
+		constexpr basic_filtered_string_view(const CharT *str) noexcept
+		requires std::constructible_from<Pred, pass_through>; // implicit Null-terminated string constructor
+		constexpr explicit basic_filtered_string_view(const CharT *str, Pred predicate) noexcept; // Null-terminated constructor
+		constexpr basic_filtered_string_view(const basic_filtered_string_view &other) noexcept; //Copy constructor
+		constexpr basic_filtered_string_view(basic_filtered_string_view &&other) noexcept; // Move constructor
 
-		filtered_string_view(const char *str, std::size_t len, filter predicate) noexcept; // implicit string constructor
+		constexpr basic_filtered_string_view(const CharT *str, std::size_t len, Pred predicate) noexcept; // explicit length constructor
 
-		~filtered_string_view() noexcept; //default_destructor
+		constexpr ~basic_filtered_string_view() noexcept; //default_destructor
 
 		// member operators
-		filtered_string_view& operator=(const filtered_string_view &other) noexcept;
-		filtered_string_view& operator=(filtered_string_view &&other) noexcept;
-		auto operator[](int n)  const -> const char &;
-		[[nodiscard]] explicit operator std::string () const noexcept;
+		constexpr basic_filtered_string_view& operator=(const basic_filtered_string_view &other) noexcept;
+		constexpr basic_filtered_string_view& operator=(basic_filtered_string_view &&other) noexcept;
+		constexpr auto operator[](int n)  const -> const CharT &;
+		[[nodiscard]] constexpr explicit operator string_type () const noexcept;
 
 		// member functions
-		[[nodiscard]] auto at(int n) const -> const char &;
-		[[nodiscard]] auto size() const noexcept-> std::size_t ;
-		[[nodiscard]] auto empty() const noexcept-> bool;
-		[[nodiscard]] auto data() const noexcept-> const char *;
-		[[nodiscard]] auto predicate() const noexcept -> const filter&;
-		[[nodiscard]] auto substr(int pos = 0, int count = 0) const -> filtered_string_view;
-
-
-		// friend functions && operators
-		friend auto operator==(const filtered_string_view &lhs, const filtered_string_view &rhs) -> bool;
-		friend auto operator<=>(const filtered_string_view &lhs, const filtered_string_view &rhs) -> std::strong_ordering;
-		friend auto operator<<(std::ostream &os, const filtered_string_view &fsv) -> std::ostream&;
-		friend auto split(const filtered_string_view &fsv, const filtered_string_view &tok) -> std::vector<filtered_string_view>;
-		friend auto substr(const filtered_string_view &fsv, int pos, int count) -> filtered_string_view;
+		[[nodiscard]] constexpr auto at(int n) const -> const CharT &;
+		[[nodiscard]] constexpr auto size() const noexcept-> std::size_t ;
+		[[nodiscard]] constexpr auto empty() const noexcept-> bool;
+		[[nodiscard]] constexpr auto data() const noexcept-> const CharT *;
+		// length of the underlying data, filtering ignored
+		[[nodiscard]] constexpr auto raw_size() const noexcept-> std::size_t;
+		[[nodiscard]] constexpr auto predicate() const noexcept -> const Pred&;
+		[[nodiscard]] constexpr auto substr(int pos = 0, int count = 0) const -> basic_filtered_string_view;
+		// The kept chars as maximal contiguous spans of the raw data, in order. Spans point into
+		// data(); the view must outlive the range.
+		[[nodiscard]] constexpr auto runs() const noexcept -> run_range;
+
+		// friend operators
+		friend constexpr auto operator==(const basic_filtered_string_view &lhs, const basic_filtered_string_view &rhs) -> bool {
+			return compare_equal_(lhs, rhs);
+		}
+		friend constexpr auto operator<=>(const basic_filtered_string_view &lhs, const basic_filtered_string_view &rhs)
+		    -> std::strong_ordering {
+			return compare_three_way_(lhs, rhs);
+		}
+		friend auto operator<<(std::basic_ostream<CharT> &os, const basic_filtered_string_view &fsv)
+		    -> std::basic_ostream<CharT>& {
+			return fsv.write_(os);
+		}
+
 	 private:
-		const char* ptr_{nullptr};
+		// Calls f with the cheapest available form of the predicate: the char_table behind a
+		// type-erased predicate when it has one, the stored predicate itself otherwise.
+		template<typename F>
+		constexpr auto visit_predicate_(F &&f) const -> decltype(auto);
+
+		static constexpr auto compare_equal_(const basic_filtered_string_view &lhs, const basic_filtered_string_view &rhs) -> bool;
+		static constexpr auto compare_three_way_(const basic_filtered_string_view &lhs, const basic_filtered_string_view &rhs)
+		    -> std::strong_ordering;
+		auto write_(std::basic_ostream<CharT> &os) const -> std::basic_ostream<CharT>&;
+
+		const CharT* ptr_{nullptr};
 		std::size_t len_{0};
-		filter predicate_func_{default_predicate};
+		Pred predicate_func_{default_predicate};
 	};
 
+	template<typename CharT>
+	basic_filtered_string_view(const CharT *) -> basic_filtered_string_view<CharT>;
+	template<typename CharT, typename Pred>
+	basic_filtered_string_view(const CharT *, Pred) -> basic_filtered_string_view<CharT, Pred>;
+	template<typename CharT, typename Pred>
+	basic_filtered_string_view(const CharT *, std::size_t, Pred) -> basic_filtered_string_view<CharT, Pred>;
+	template<typename CharT>
+	basic_filtered_string_view(const std::basic_string<CharT> &) -> basic_filtered_string_view<CharT>;
+	template<typename CharT, typename Pred>
+	basic_filtered_string_view(const std::basic_string<CharT> &, Pred) -> basic_filtered_string_view<CharT, Pred>;
+
+	using filtered_string_view = basic_filtered_string_view<char, filter>;
+
+	template<typename CharT, typename Pred>
+	[[nodiscard]] constexpr auto substr(const basic_filtered_string_view<CharT, Pred> &fsv, int pos = 0, int count = 0)
+	    -> basic_filtered_string_view<CharT, Pred>;
+	template<typename CharT, typename Pred, typename TokPred>
+	[[nodiscard]] constexpr auto split(const basic_filtered_string_view<CharT, Pred> &fsv, const basic_filtered_string_view<CharT, TokPred> &tok)
+	    -> std::vector<basic_filtered_string_view<CharT, Pred>>;
+
+	// type-erased overloads, compiled once and accepting anything convertible to filtered_string_view
 	[[nodiscard]] auto substr(const filtered_string_view &fsv, int pos = 0, int count = 0) -> filtered_string_view;
+	// Keeps what fsv and every filter in filts keep, over the raw data of fsv. Table-backed filters
+	// (and those of nested composes) are fused into a single char_table.
 	[[nodiscard]] auto compose(const filtered_string_view &fsv, const std::vector<std::function<bool(const char &)>> &filts) -> filtered_string_view;
 	[[nodiscard]] auto split(const filtered_string_view &fsv, const filtered_string_view &tok) -> std::vector<filtered_string_view>;
+	// Same view with its predicate evaluated once per byte value into a char_table.
+	// The predicate must be a pure function of the char.
+	[[nodiscard]] auto tabulate(const filtered_string_view &fsv) -> filtered_string_view;
+
+	// default constructors
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view() noexcept
+	requires std::constructible_from<Pred, pass_through>
+	= default;
+	// implicit string constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(const string_type &str) noexcept
+	requires std::constructible_from<Pred, pass_through>
+	: ptr_{str.data()}, len_{str.size()} {}
+	// predicate constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(const string_type &str, Pred predicate) noexcept
+	: ptr_{str.data()}, len_{str.size()}, predicate_func_{std::move(predicate)} {}
+	// implicit Null-terminated string constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(const CharT *str) noexcept
+	requires std::constructible_from<Pred, pass_through>
+	: ptr_{str}, len_{std::char_traits<CharT>::length(str)} {}
+	// Null-terminated constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(const CharT *str, Pred predicate) noexcept
+	: ptr_{str}, len_{std::char_traits<CharT>::length(str)}, predicate_func_{std::move(predicate)} {}
+	// copy constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(const basic_filtered_string_view &other) noexcept
+	: ptr_{other.ptr_}, len_{other.len_}, predicate_func_{other.predicate_func_} {}
+	// move constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(basic_filtered_string_view &&other) noexcept
+	: ptr_{other.ptr_}, len_{other.len_}, predicate_func_{std::move(other.predicate_func_)} {
+		other.ptr_ = nullptr;
+		other.len_ = 0;
+		if constexpr (std::is_assignable_v<Pred &, pass_through>) {
+			other.predicate_func_ = default_predicate;
+		}
+	}
+	// explicit length constructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::basic_filtered_string_view(const CharT *str, std::size_t len, Pred predicate) noexcept
+	: ptr_{str}, len_{len}, predicate_func_{std::move(predicate)} {}
+
+	// destructor
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::~basic_filtered_string_view() noexcept = default;
+
+	// copy assignment
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::operator=(const basic_filtered_string_view &other) noexcept
+	    -> basic_filtered_string_view & = default;
+	// move assignment
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::operator=(basic_filtered_string_view &&other) noexcept
+	    -> basic_filtered_string_view & {
+		if (this == &other) {
+			return *this;
+		}
+		ptr_ = other.ptr_;
+		len_ = other.len_;
+		predicate_func_ = std::move(other.predicate_func_);
+		other.ptr_ = nullptr;
+		other.len_ = 0;
+		if constexpr (std::is_assignable_v<Pred &, pass_through>) {
+			other.predicate_func_ = default_predicate;
+		}
+		return *this;
+	}
+
+	template<typename CharT, typename Pred>
+	template<typename F>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::visit_predicate_(F &&f) const -> decltype(auto) {
+		return detail::visit_predicate<CharT>(predicate_func_, std::forward<F>(f));
+	}
+
+	// Subscript
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::operator[](int n) const -> const CharT & {
+		return at(n);
+	}
+
+	// std::string conversion
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::operator string_type() const noexcept {
+		FSV_STATS_SCOPE(to_string);
+		if (ptr_ == nullptr) {
+			return string_type{};
+		}
+		return visit_predicate_([this](const auto &pred) {
+			string_type res_;
+			if constexpr (detail::uses_kernels_v<CharT, decltype(pred)>) {
+				if (!std::is_constant_evaluated()) {
+					// size exactly, then let the compaction kernel fill it in bulk
+					stats::note_allocation();
+					res_.resize(detail::count_kept(ptr_, len_, pred) + detail::compact_slack);
+					res_.resize(detail::compact_kept(ptr_, len_, pred, res_.data()));
+					return res_;
+				}
+			}
+			for (std::size_t i = 0; i < len_; ++i) {
+				if (pred(ptr_[i])) {
+					if (res_.size() == res_.capacity()) {
+						stats::note_allocation();
+					}
+					res_ += ptr_[i];
+				}
+			}
+			return res_;
+		});
+	}
+
+	// member functions
+	// Throws: a std::domain_error{"filtered_string_view::at(<index>): invalid index"},
+	// where <index> should be replaced with the actual index passed in if the index is invalid.
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::at(int n) const -> const CharT & {
+		FSV_STATS_SCOPE(at);
+		if (n >= static_cast<int>(len_) || n < 0 || ptr_ == nullptr) {
+			detail::throw_invalid_index(n);
+		}
+		const auto *res_ = visit_predicate_([this, n](const auto &pred) -> const CharT * {
+			int index_ = 0;
+			for (std::size_t i = 0; i < len_; ++i) {
+				if (pred(ptr_[i])) {
+					if (index_ == n) {
+						return ptr_ + i;
+					}
+					++index_;
+				}
+			}
+			return nullptr;
+		});
+		if (res_ == nullptr) {
+			detail::throw_invalid_index(n);
+		}
+		return *res_;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::size() const noexcept -> std::size_t {
+		FSV_STATS_SCOPE(size);
+		if (ptr_ == nullptr) {
+			return 0;
+		}
+		return visit_predicate_([this](const auto &pred) {
+			if constexpr (detail::uses_kernels_v<CharT, decltype(pred)>) {
+				if (!std::is_constant_evaluated()) {
+					return detail::count_kept(ptr_, len_, pred);
+				}
+			}
+			std::size_t res_ = 0;
+			for (std::size_t i = 0; i < len_; ++i) {
+				if (pred(ptr_[i])) {
+					++res_;
+				}
+			}
+			return res_;
+		});
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::empty() const noexcept -> bool {
+		FSV_STATS_SCOPE(empty);
+		if (ptr_ == nullptr) {
+			return true;
+		}
+		return visit_predicate_([this](const auto &pred) {
+			if constexpr (detail::uses_kernels_v<CharT, decltype(pred)>) {
+				if (!std::is_constant_evaluated()) {
+					return detail::find_kept(ptr_, len_, pred) == len_;
+				}
+			}
+			for (std::size_t i = 0; i < len_; ++i) {
+				if (pred(ptr_[i])) {
+					return false;
+				}
+			}
+			return true;
+		});
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::data() const noexcept -> const CharT * {
+		return ptr_;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::raw_size() const noexcept -> std::size_t {
+		return len_;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::predicate() const noexcept -> const Pred & {
+		return predicate_func_;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::substr(int pos, int count) const -> basic_filtered_string_view {
+		return fsv::substr(*this, pos, count);
+	}
+
+	// Both comparisons walk the two views once with independent cursors and stop at the
+	// first difference; views that keep everything compare their raw data directly.
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::compare_equal_(const basic_filtered_string_view &lhs,
+	                                                             const basic_filtered_string_view &rhs) -> bool {
+		FSV_STATS_SCOPE(compare);
+		return lhs.visit_predicate_([&lhs, &rhs](const auto &lpred) {
+			return rhs.visit_predicate_([&lhs, &rhs, &lpred](const auto &rpred) {
+				if (detail::is_pass_through(lpred) && detail::is_pass_through(rpred)) {
+					return lhs.len_ == rhs.len_
+					       && (lhs.len_ == 0 || std::char_traits<CharT>::compare(lhs.ptr_, rhs.ptr_, lhs.len_) == 0);
+				}
+				std::size_t i = 0;
+				std::size_t j = 0;
+				for (;; ++i, ++j) {
+					while (i < lhs.len_ && !lpred(lhs.ptr_[i])) {
+						++i;
+					}
+					while (j < rhs.len_ && !rpred(rhs.ptr_[j])) {
+						++j;
+					}
+					if (i == lhs.len_ || j == rhs.len_) {
+						return i == lhs.len_ && j == rhs.len_;
+					}
+					if (lhs.ptr_[i] != rhs.ptr_[j]) {
+						return false;
+					}
+				}
+			});
+		});
+	}
+
+	// Note a view that is a proper prefix of the other orders after it.
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::compare_three_way_(const basic_filtered_string_view &lhs,
+	                                                                 const basic_filtered_string_view &rhs)
+	    -> std::strong_ordering {
+		FSV_STATS_SCOPE(compare);
+		return lhs.visit_predicate_([&lhs, &rhs](const auto &lpred) {
+			return rhs.visit_predicate_([&lhs, &rhs, &lpred](const auto &rpred) -> std::strong_ordering {
+				if (detail::is_pass_through(lpred) && detail::is_pass_through(rpred)) {
+					const auto n_ = std::min(lhs.len_, rhs.len_);
+					const auto [l_, r_] = std::mismatch(lhs.ptr_, lhs.ptr_ + n_, rhs.ptr_);
+					if (l_ != lhs.ptr_ + n_) {
+						return *l_ <=> *r_;
+					}
+					return rhs.len_ <=> lhs.len_;
+				}
+				std::size_t i = 0;
+				std::size_t j = 0;
+				for (;; ++i, ++j) {
+					while (i < lhs.len_ && !lpred(lhs.ptr_[i])) {
+						++i;
+					}
+					while (j < rhs.len_ && !rpred(rhs.ptr_[j])) {
+						++j;
+					}
+					if (i == lhs.len_ || j == rhs.len_) {
+						if (i == lhs.len_ && j == rhs.len_) {
+							return std::strong_ordering::equal;
+						}
+						return i == lhs.len_ ? std::strong_ordering::greater : std::strong_ordering::less;
+					}
+					if (lhs.ptr_[i] != rhs.ptr_[j]) {
+						return lhs.ptr_[i] <=> rhs.ptr_[j];
+					}
+				}
+			});
+		});
+	}
+
+	template<typename CharT, typename Pred>
+	auto basic_filtered_string_view<CharT, Pred>::write_(std::basic_ostream<CharT> &os) const -> std::basic_ostream<CharT> & {
+		FSV_STATS_SCOPE(write);
+		// one write per run of kept chars; output stops after the first kept null char
+		detail::visit_predicate<CharT>(predicate_func_, [&](const auto &pred) {
+			detail::for_each_run(ptr_, len_, pred, [&os](const CharT *run, std::size_t n) {
+				const auto *nul_ = std::char_traits<CharT>::find(run, n, CharT{});
+				const auto count_ = nul_ == nullptr ? n : static_cast<std::size_t>(nul_ - run) + 1;
+				os.write(run, static_cast<std::streamsize>(count_));
+				return nul_ == nullptr;
+			});
+		});
+		return os;
+	}
+
+	// Single pass: the delimiter is materialised once and matched with memchr when it is one
+	// char, Horspool on the raw data when fsv keeps every char, and KMP over the kept chars
+	// otherwise. Pieces are cut straight from raw offsets, trimmed to their kept chars.
+	template<typename CharT, typename Pred, typename TokPred>
+	constexpr auto split(const basic_filtered_string_view<CharT, Pred> &fsv, const basic_filtered_string_view<CharT, TokPred> &tok)
+	    -> std::vector<basic_filtered_string_view<CharT, Pred>> {
+		FSV_STATS_SCOPE(split);
+		using view_type = basic_filtered_string_view<CharT, Pred>;
+		std::vector<view_type> res_;
+		const auto delim_ = static_cast<std::basic_string<CharT>>(tok);
+		const auto m_ = delim_.size();
+		if (m_ == 0 || fsv.size() < m_) {
+			res_.push_back(fsv);
+			return res_;
+		}
+		const auto *ptr_ = fsv.data();
+		const auto len_ = fsv.raw_size();
+		detail::visit_predicate<CharT>(fsv.predicate(), [&](const auto &pred) {
+			auto emit_ = [&](std::size_t first, std::size_t last) {
+				while (first < last && !pred(ptr_[first])) {
+					++first;
+				}
+				while (last > first && !pred(ptr_[last - 1])) {
+					--last;
+				}
+				if (res_.size() == res_.capacity()) {
+					stats::note_allocation();
+				}
+				res_.push_back(first == last ? view_type{ptr_, 0, fsv.predicate()}
+				                             : view_type{ptr_ + first, last - first, fsv.predicate()});
+			};
+			std::size_t prev_ = 0;
+			if (m_ == 1) {
+				// every raw occurrence of a kept delimiter is a match
+				if (pred(delim_[0])) {
+					const CharT *hit_;
+					while ((hit_ = std::char_traits<CharT>::find(ptr_ + prev_, len_ - prev_, delim_[0])) != nullptr) {
+						const auto pos_ = static_cast<std::size_t>(hit_ - ptr_);
+						emit_(prev_, pos_);
+						prev_ = pos_ + 1;
+					}
+				}
+			}
+			else if (detail::is_pass_through(pred) && !std::is_constant_evaluated()) {
+				detail::for_each_match(ptr_, len_, delim_, [&](std::size_t pos) {
+					emit_(prev_, pos);
+					prev_ = pos + m_;
+				});
+			}
+			else {
+				const auto fail_ = detail::kmp_failure(delim_);
+				std::size_t k = 0;
+				for (std::size_t i = 0; i < len_; ++i) {
+					if (!pred(ptr_[i])) {
+						continue;
+					}
+					while (k > 0 && ptr_[i] != delim_[k]) {
+						k = fail_[k - 1];
+					}
+					if (ptr_[i] == delim_[k]) {
+						++k;
+					}
+					if (k == m_) {
+						// walk back over the match to find where it starts in the raw data
+						auto start_ = i;
+						for (std::size_t kept_ = 1; kept_ < m_; ) {
+							--start_;
+							if (pred(ptr_[start_])) {
+								++kept_;
+							}
+						}
+						emit_(prev_, start_);
+						prev_ = i + 1;
+						k = 0;
+					}
+				}
+			}
+			emit_(prev_, len_);
+		});
+		return res_;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto substr(const basic_filtered_string_view<CharT, Pred> &fsv, int pos, int count)
+	    -> basic_filtered_string_view<CharT, Pred> {
+		FSV_STATS_SCOPE(substr);
+		const auto size_ = static_cast<int>(fsv.size());
+		auto rcount = count <= 0 ? size_ - pos : count;
+		if (pos < 0 || pos >= size_ || rcount < 0) {
+			std::string err_msg = "filtered_string_view::substr(" + std::to_string(pos) + ", " + std::to_string(count) + "): invalid index";
+			throw std::domain_error{err_msg.c_str()};
+		}
+
+		const auto *ptr_ = fsv.data();
+		const auto len_ = fsv.raw_size();
+		auto count_ = std::min(size_ - pos, rcount);
+		return detail::visit_predicate<CharT>(fsv.predicate(), [&](const auto &pred) {
+			const CharT *new_ptr_ = ptr_;
+			std::size_t i;
+			int index_ = 0;
+			for (i = 0; i < len_; ++i) {
+				if (pred(ptr_[i])) {
+					if (index_ == pos) {
+						new_ptr_ = ptr_ + i;
+						break;
+					}
+					++index_;
+				}
+			}
+			auto i_ = i;
+			index_ = 0;
+			for (; i < len_; ++i) {
+				if (index_ == count_) break;
+				if (pred(ptr_[i])) {
+					++index_;
+				}
+			}
+			return basic_filtered_string_view<CharT, Pred>{new_ptr_, i - i_, fsv.predicate()};
+		});
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::iter::iter(const CharT *ptr, const Pred &pred, std::size_t len, bool ending) noexcept
+	: iter_ptr_{ptr + len}, begin_{ptr}, end_{ptr + len}, pred_{pred} {
+		if (ending) {
+			return;
+		}
+		if constexpr (std::is_same_v<CharT, char>) {
+			const auto *table_ = detail::table_of(pred_);
+			if (table_ != nullptr && !std::is_constant_evaluated()) {
+				iter_ptr_ = ptr + detail::find_kept(ptr, len, *table_);
+				return;
+			}
+		}
+		iter_ptr_ = begin_;
+		while (iter_ptr_ != end_ && !keep_(*iter_ptr_)) {
+			++iter_ptr_;
+		}
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::iter::keep_(CharT c) const -> bool {
+		if constexpr (std::is_same_v<CharT, char>) {
+			if (const auto *table_ = detail::table_of(pred_)) {
+				stats::note_bytes_scanned(1);
+				return table_->test(c);
+			}
+		}
+		if constexpr (!std::is_same_v<Pred, filter>) {
+			stats::note_predicate_call();
+		}
+		return pred_(c);
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::iter::operator*() const -> reference {
+		return *iter_ptr_;
+	}
+
+	template<typename CharT, typename Pred>
+	auto basic_filtered_string_view<CharT, Pred>::iter::operator->() const -> pointer {
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::iter::operator++() -> iter & {
+		FSV_STATS_SCOPE(iterate);
+		do {
+			++iter_ptr_;
+		} while (iter_ptr_ != end_ && !keep_(*iter_ptr_));
+		return *this;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::iter::operator++(int) -> iter {
+		iter temp (*this);
+		++*this;
+		return temp;
+	}
+
+	// there must be a kept char before the current position, as with any bidirectional iterator
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::iter::operator--() -> iter & {
+		FSV_STATS_SCOPE(iterate);
+		do {
+			--iter_ptr_;
+		} while (iter_ptr_ != begin_ && !keep_(*iter_ptr_));
+		return *this;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::iter::operator--(int) -> iter {
+		iter temp (*this);
+		--*this;
+		return temp;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr basic_filtered_string_view<CharT, Pred>::run_range::run_iter::run_iter(const basic_filtered_string_view *fsv, std::size_t from)
+	: fsv_{fsv}, first_{from}, last_{from} {
+		FSV_STATS_SCOPE(runs);
+		std::tie(first_, last_) = fsv_->visit_predicate_([&](const auto &pred) {
+			return detail::next_run(fsv_->ptr_, fsv_->len_, from, pred);
+		});
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::run_range::run_iter::operator*() const -> reference {
+		return value_type{fsv_->ptr_ + first_, last_ - first_};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::run_range::run_iter::operator++() -> run_iter & {
+		// the char at last_ is dropped, or the end
+		if (last_ == fsv_->len_) {
+			first_ = last_;
+		}
+		else {
+			*this = run_iter{fsv_, last_ + 1};
+		}
+		return *this;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::run_range::run_iter::operator++(int) -> run_iter {
+		auto copy_ = *this;
+		++*this;
+		return copy_;
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::runs() const noexcept -> run_range {
+		return run_range{this};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::begin() const noexcept -> iterator {
+		FSV_STATS_SCOPE(iterate);
+		return iterator{data(), predicate(), len_};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::end() const noexcept -> iterator {
+		return iterator{data(), predicate(), len_, true};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::cbegin() const noexcept -> const_iterator {
+		return begin();
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::cend() const noexcept -> const_iterator {
+		return end();
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::rbegin() const noexcept -> reverse_iterator {
+		return reverse_iterator{end()};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::rend() const noexcept -> reverse_iterator {
+		return reverse_iterator{begin()};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::crbegin() const noexcept -> const_reverse_iterator {
+		return reverse_iterator{cend()};
+	}
+
+	template<typename CharT, typename Pred>
+	constexpr auto basic_filtered_string_view<CharT, Pred>::crend() const noexcept -> const_reverse_iterator {
+		return reverse_iterator{cbegin()};
+	}
 
+	// the type-erased view is compiled once, in filtered_string_view.cpp
+	extern template class basic_filtered_string_view<char, filter>;
 }
 
 #endif // COMP6771_ASS2_FSV_H
@@ -1,8 +1,13 @@
 #include "./filtered_string_view.h"
+#include "./pred.h"
 
 #include <catch2/catch.hpp>
+#include <random>
 #include <set>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 TEST_CASE("static member test") {
 	for (char c = std::numeric_limits<char>::min(); c != std::numeric_limits<char>::max(); c++) {
@@ -326,4 +331,529 @@ TEST_CASE("iterator && range") {
 		REQUIRE(it == it_e);
 	}
 
-}
\ No newline at end of file
+	SECTION("iterators outlive their view"){
+		const auto *text = "Ragdoll Cat";
+		auto vowels = [](const char &c){ return c == 'a' || c == 'o'; };
+		auto it = fsv::filtered_string_view{text, vowels}.begin();
+		REQUIRE(*++it == 'o');
+
+		auto sv = fsv::filtered_string_view{text, fsv::char_table{vowels}};
+		auto it_t = sv.begin();
+		auto table_sv = fsv::basic_filtered_string_view<char, fsv::char_table>{text, fsv::char_table{vowels}};
+		auto it_b = table_sv.begin();
+		auto it_e = table_sv.end();
+		// a predicate that keeps everything: the iterators keep filtering with their own copy
+		sv = fsv::filtered_string_view{text};
+		table_sv = fsv::basic_filtered_string_view<char, fsv::char_table>{text, ~fsv::char_table{}};
+		REQUIRE(*++it_t == 'o');
+		REQUIRE(std::string(it_b, it_e) == "aoa");
+		REQUIRE(*--it_e == 'a');
+
+		auto s = std::string{};
+		for (char c : fsv::filtered_string_view{text, vowels}) {
+			s += c;
+		}
+		REQUIRE(s == "aoa");
+	}
+
+}
+
+TEST_CASE("char_table") {
+
+	SECTION("tabulates a predicate"){
+		constexpr auto digits = fsv::char_table{[](const char &c){ return c >= '0' && c <= '9'; }};
+		static_assert(digits.count() == 10);
+		REQUIRE(digits('7'));
+		REQUIRE_FALSE(digits('a'));
+		REQUIRE_FALSE(fsv::char_table{}.test('a'));
+		REQUIRE(fsv::char_table{fsv::filtered_string_view::default_predicate}.all());
+	}
+
+	SECTION("drives the view"){
+		auto sv = fsv::filtered_string_view{"only 90s kids understand",
+			fsv::char_table{[](const char &c){ return c == '9' || c == '0' || c == ' '; }}};
+		REQUIRE(sv.size() == 5);
+		REQUIRE_FALSE(sv.empty());
+		REQUIRE(static_cast<std::string>(sv) == " 90  ");
+		REQUIRE(std::string{sv.begin(), sv.end()} == " 90  ");
+		REQUIRE(std::string{sv.rbegin(), sv.rend()} == "  09 ");
+	}
+
+	SECTION("tabulate"){
+		auto vowels = std::set<char>{'a', 'e', 'i', 'o', 'u'};
+		auto sv = fsv::filtered_string_view{"The best breed of cats is Ragdoll",
+			[&vowels](const char &c){ return vowels.contains(c); }};
+		auto tv = fsv::tabulate(sv);
+		REQUIRE(tv.predicate().target<fsv::char_table>() != nullptr);
+		REQUIRE(tv.data() == sv.data());
+		REQUIRE(tv == sv);
+		REQUIRE(static_cast<std::string>(tv) == static_cast<std::string>(sv));
+		auto none = fsv::tabulate(fsv::filtered_string_view{"Ragdoll", [](const char &){ return false; }});
+		REQUIRE(none.empty());
+		REQUIRE(none.size() == 0);
+	}
+}
+
+TEST_CASE("basic_filtered_string_view") {
+
+	SECTION("stores lambdas by value"){
+		auto not_space = [](const char &c){ return c != ' '; };
+		auto sv = fsv::basic_filtered_string_view{"The best breed", not_space};
+		static_assert(std::is_same_v<decltype(sv)::predicate_type, decltype(not_space)>);
+		REQUIRE(sv.size() == 12);
+		REQUIRE(sv.at(3) == 'b');
+		REQUIRE(static_cast<std::string>(sv) == "Thebestbreed");
+		REQUIRE(std::string{sv.begin(), sv.end()} == "Thebestbreed");
+		REQUIRE(fsv::substr(sv, 3, 4) == fsv::basic_filtered_string_view{"best", not_space});
+	}
+
+	SECTION("default predicate"){
+		auto sv = fsv::basic_filtered_string_view{"Ragdoll"};
+		static_assert(std::is_same_v<decltype(sv), fsv::filtered_string_view>);
+		auto tv = fsv::basic_filtered_string_view<char, fsv::char_table>{"Ragdoll"};
+		REQUIRE(tv.size() == 7);
+		REQUIRE(tv.predicate().all());
+	}
+
+	SECTION("split and compare"){
+		auto no_digits = [](const char &c){ return c < '0' || c > '9'; };
+		auto sv = fsv::basic_filtered_string_view{"1x2a3x4b5", no_digits};
+		auto tok = fsv::basic_filtered_string_view{"x", no_digits};
+		auto v = fsv::split(sv, tok);
+		REQUIRE(v.size() == 3);
+		REQUIRE(static_cast<std::string>(v[0]) == "");
+		REQUIRE(static_cast<std::string>(v[1]) == "a");
+		REQUIRE(static_cast<std::string>(v[2]) == "b");
+		REQUIRE(v[1] < v[2]);
+		REQUIRE(v[0] != v[1]);
+	}
+
+	SECTION("wide chars"){
+		auto sv = fsv::basic_filtered_string_view{L"Ragdoll Cat", [](const wchar_t &c){ return c != L' '; }};
+		REQUIRE(sv.size() == 10);
+		REQUIRE(static_cast<std::wstring>(sv) == L"RagdollCat");
+		std::wostringstream os;
+		os << sv;
+		REQUIRE(os.str() == L"RagdollCat");
+	}
+
+	SECTION("moved-from state"){
+		auto is_upper = [](const char &c){ return c >= 'A' && c <= 'Z'; };
+		auto sv = fsv::basic_filtered_string_view{"Sled Dog", is_upper};
+		auto moved = std::move(sv);
+		REQUIRE(moved.size() == 2);
+		REQUIRE(sv.data() == nullptr);
+		REQUIRE(sv.size() == 0);
+	}
+}
+
+TEST_CASE("comparison") {
+
+	SECTION("different predicates and layouts"){
+		auto sv1 = fsv::filtered_string_view{"R-a-g-d-o-l-l", [](const char &c){ return c != '-'; }};
+		auto sv2 = fsv::filtered_string_view{"Ragdoll"};
+		auto sv3 = fsv::filtered_string_view{"Ragd  oll!", [](const char &c){ return c != ' ' && c != '!'; }};
+		REQUIRE(sv1 == sv2);
+		REQUIRE(sv2 == sv3);
+		REQUIRE(sv1 == sv3);
+		REQUIRE((sv1 <=> sv3) == std::strong_ordering::equal);
+	}
+
+	SECTION("first mismatch decides"){
+		auto sv1 = fsv::filtered_string_view{"Ragdoll", [](const char &c){ return c != 'R'; }};
+		auto sv2 = fsv::filtered_string_view{"abc"};
+		REQUIRE(sv1 != sv2);
+		REQUIRE(sv1 > sv2);
+		REQUIRE(sv2 < sv1);
+	}
+
+	SECTION("prefixes order after longer strings"){
+		auto sv1 = fsv::filtered_string_view{"Rag doll", [](const char &c){ return c != ' '; }};
+		auto sv2 = fsv::filtered_string_view{"Ragdoll Cat", [](const char &c){ return c != ' '; }};
+		REQUIRE(sv1 != sv2);
+		REQUIRE(sv1 > sv2);
+		REQUIRE(fsv::filtered_string_view{""} > sv2);
+		REQUIRE(fsv::filtered_string_view{} == fsv::filtered_string_view{""});
+	}
+
+	SECTION("pass-through views"){
+		auto s1 = std::string{"Ragdoll\xff"};
+		auto s2 = std::string{"Ragdoll\x01"};
+		auto sv1 = fsv::filtered_string_view{s1};
+		auto sv2 = fsv::filtered_string_view{s2};
+		REQUIRE(sv1 != sv2);
+		// chars compare as char, like the filtered comparison does
+		REQUIRE((sv1 <=> sv2) == (s1.back() <=> s2.back()));
+		auto filtered1 = fsv::filtered_string_view{s1, [](const char &){ return true; }};
+		REQUIRE((filtered1 <=> sv2) == (sv1 <=> sv2));
+		REQUIRE(fsv::substr(sv1, 0, 7) == fsv::substr(sv2, 0, 7));
+	}
+}
+
+TEST_CASE("split with longer delimiters") {
+	auto strings = [](const std::vector<fsv::filtered_string_view> &v) {
+		auto res = std::vector<std::string>{};
+		for (const auto &piece : v) {
+			res.push_back(static_cast<std::string>(piece));
+		}
+		return res;
+	};
+
+	SECTION("unfiltered"){
+		auto v = fsv::split(fsv::filtered_string_view{"xx, yy, , zz, "}, fsv::filtered_string_view{", "});
+		REQUIRE(strings(v) == std::vector<std::string>{"xx", "yy", "", "zz", ""});
+		auto w = fsv::split(fsv::filtered_string_view{"a,,,b"}, fsv::filtered_string_view{",,"});
+		REQUIRE(strings(w) == std::vector<std::string>{"a", ",b"});
+		auto none = fsv::split(fsv::filtered_string_view{"a, b"}, fsv::filtered_string_view{"; "});
+		REQUIRE(strings(none) == std::vector<std::string>{"a, b"});
+	}
+
+	SECTION("matches span filtered out chars"){
+		auto no_stars = [](const char &c){ return c != '*'; };
+		auto sv = fsv::filtered_string_view{"*ab,* cd*,*, *ef", no_stars};
+		auto v = fsv::split(sv, fsv::filtered_string_view{", "});
+		REQUIRE(strings(v) == std::vector<std::string>{"ab", "cd,", "ef"});
+		// pieces point into the original data and skip filtered chars at their ends
+		REQUIRE(v[0].data() == sv.data() + 1);
+		REQUIRE(v[0].raw_size() == 2);
+		REQUIRE(v[2].data() == sv.data() + 14);
+	}
+
+	SECTION("delimiter filtered out of the view"){
+		auto no_commas = [](const char &c){ return c != ','; };
+		auto v = fsv::split(fsv::filtered_string_view{"a,b", no_commas}, fsv::filtered_string_view{","});
+		REQUIRE(strings(v) == std::vector<std::string>{"ab"});
+	}
+
+	SECTION("agrees with splitting the materialised string"){
+		auto gen = std::mt19937{11};
+		auto dist = std::uniform_int_distribution<int>{0, 3};
+		const auto alphabet = std::string{"ab*,"};
+		auto no_stars = [](const char &c){ return c != '*'; };
+		for (int round = 0; round < 200; ++round) {
+			auto s = std::string{};
+			for (int i = 0; i < 40; ++i) {
+				s += alphabet[static_cast<std::size_t>(dist(gen))];
+			}
+			for (const auto &delim : {std::string{","}, std::string{"a,"}, std::string{"aa"}, std::string{"aba"}}) {
+				const auto sv = fsv::filtered_string_view{s, no_stars};
+				const auto kept = static_cast<std::string>(sv);
+				auto expected = std::vector<std::string>{};
+				std::size_t prev = 0;
+				for (auto pos = kept.find(delim); pos != std::string::npos; pos = kept.find(delim, prev)) {
+					expected.push_back(kept.substr(prev, pos - prev));
+					prev = pos + delim.size();
+				}
+				expected.push_back(kept.substr(prev));
+				if (kept.size() < delim.size()) {
+					expected = {kept};
+				}
+				REQUIRE(strings(fsv::split(sv, fsv::filtered_string_view{delim})) == expected);
+				REQUIRE(strings(fsv::split(fsv::filtered_string_view{kept}, fsv::filtered_string_view{delim})) == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("iterators only scan as far as they move") {
+	auto calls = 0;
+	auto counted = [&calls](const char &c){ ++calls; return c != '_'; };
+	const auto s = std::string(1000, '_') + "ab" + std::string(1000, '_');
+	auto sv = fsv::filtered_string_view{s, counted};
+
+	auto last = sv.end();
+	REQUIRE(calls == 0);
+	auto it = sv.begin();
+	REQUIRE(calls == 1001);
+	REQUIRE(*it == 'a');
+	REQUIRE(*++it == 'b');
+	REQUIRE(++it == last);
+	REQUIRE(*--last == 'b');
+	REQUIRE(*--last == 'a');
+	REQUIRE(last == sv.begin());
+
+	auto chars = std::string{};
+	for (auto rit = sv.rbegin(); rit != sv.rend(); ++rit) {
+		chars += *rit;
+	}
+	REQUIRE(chars == "ba");
+	const auto blanks = std::string(10, '_');
+	const auto empty = fsv::filtered_string_view{blanks, counted};
+	REQUIRE(empty.begin() == empty.end());
+}
+
+namespace {
+	// records each chunk the stream hands over
+	struct chunk_buf : std::streambuf {
+		auto xsputn(const char *s, std::streamsize n) -> std::streamsize override {
+			chunks.emplace_back(s, static_cast<std::size_t>(n));
+			return n;
+		}
+		auto overflow(int_type c) -> int_type override {
+			chunks.emplace_back(1, traits_type::to_char_type(c));
+			return c;
+		}
+		std::vector<std::string> chunks;
+	};
+}
+
+TEST_CASE("output is written one run at a time") {
+	const auto s = std::string{"--ab--c---def-"};
+	auto not_dash = [](const char &c){ return c != '-'; };
+	for (const auto &sv : {fsv::filtered_string_view{s, not_dash}, fsv::filtered_string_view{s, fsv::char_table{not_dash}}}) {
+		auto buf = chunk_buf{};
+		auto os = std::ostream{&buf};
+		os << sv;
+		REQUIRE(buf.chunks == std::vector<std::string>{"ab", "c", "def"});
+	}
+
+	SECTION("output stops after a kept null char") {
+		const auto raw = std::string{"ab-c\0d-e", 9};
+		auto buf = chunk_buf{};
+		auto os = std::ostream{&buf};
+		os << fsv::filtered_string_view{raw, fsv::char_table{not_dash}};
+		REQUIRE(buf.chunks == std::vector<std::string>{"ab", std::string{"c\0", 2}});
+	}
+
+	SECTION("agrees with at() across random inputs") {
+		auto gen = std::mt19937{17};
+		for (auto i = 0; i < 200; ++i) {
+			auto raw = std::string(gen() % 300, ' ');
+			for (auto &c : raw) {
+				c = "ab-\0"[gen() % 4];
+			}
+			const auto keep_nul = static_cast<bool>(gen() % 2);
+			auto pred = [keep_nul](const char &c){ return c != '-' && (keep_nul || c != '\0'); };
+			auto expected = std::string{};
+			const auto sv = fsv::filtered_string_view{raw, pred};
+			for (auto j = 0; j < static_cast<int>(sv.size()); ++j) {
+				expected += sv.at(j);
+				if (sv.at(j) == '\0') {
+					break;
+				}
+			}
+			auto os = std::ostringstream{};
+			os << fsv::filtered_string_view{raw, fsv::char_table{pred}};
+			REQUIRE(os.str() == expected);
+			os.str("");
+			os << sv;
+			REQUIRE(os.str() == expected);
+		}
+	}
+}
+
+TEST_CASE("runs") {
+	using runs_type = decltype(fsv::filtered_string_view{}.runs());
+	STATIC_REQUIRE(std::ranges::forward_range<runs_type>);
+	STATIC_REQUIRE(std::ranges::view<runs_type>);
+
+	const auto s = std::string{"--ab--c---def-"};
+	auto not_dash = [](const char &c){ return c != '-'; };
+	for (const auto &sv : {fsv::filtered_string_view{s, not_dash}, fsv::filtered_string_view{s, fsv::char_table{not_dash}}}) {
+		auto runs = std::vector<std::string_view>{};
+		for (auto run : sv.runs()) {
+			runs.push_back(run);
+		}
+		REQUIRE(runs == std::vector<std::string_view>{"ab", "c", "def"});
+		REQUIRE(runs[0].data() == s.data() + 2);
+		REQUIRE(runs[2].data() == s.data() + 10);
+	}
+
+	SECTION("views with nothing dropped are one run") {
+		const auto sv = fsv::filtered_string_view{s};
+		REQUIRE(std::ranges::distance(sv.runs()) == 1);
+		REQUIRE(sv.runs().front() == s);
+		REQUIRE(fsv::filtered_string_view{}.runs().empty());
+		REQUIRE(fsv::filtered_string_view{s, [](const char &){ return false; }}.runs().empty());
+	}
+
+	SECTION("agree with the kept chars across random inputs") {
+		auto gen = std::mt19937{18};
+		for (auto i = 0; i < 200; ++i) {
+			auto raw = std::string(gen() % 500, ' ');
+			for (auto &c : raw) {
+				c = gen() % 5 == 0 ? '-' : 'a';
+			}
+			for (const auto &sv : {fsv::filtered_string_view{raw, not_dash}, fsv::filtered_string_view{raw, fsv::char_table{not_dash}}}) {
+				auto joined = std::string{};
+				const char *prev_end = nullptr;
+				for (auto run : sv.runs()) {
+					REQUIRE_FALSE(run.empty());
+					REQUIRE(run.data() != prev_end); // maximal: never adjacent to the previous run
+					prev_end = run.data() + run.size();
+					joined += run;
+				}
+				REQUIRE(joined == static_cast<std::string>(sv));
+			}
+		}
+	}
+
+	STATIC_REQUIRE(std::ranges::distance(fsv::basic_filtered_string_view{"a,,bc,d", fsv::pred::not_(fsv::pred::is(','))}.runs()) == 3);
+}
+
+TEST_CASE("filter") {
+	SECTION("empty filters keep everything"){
+		const auto f = fsv::filter{};
+		REQUIRE(f('a'));
+		REQUIRE(f('\0'));
+		REQUIRE(f.target<fsv::pass_through>() != nullptr);
+		REQUIRE(f.table() != nullptr);
+		REQUIRE(f.table()->all());
+		REQUIRE(fsv::filter{fsv::pass_through{}}.target<fsv::pass_through>() != nullptr);
+	}
+
+	SECTION("targets and tables"){
+		const auto no_spaces = fsv::char_table{[](const char &c){ return c != ' '; }};
+		const auto f = fsv::filter{no_spaces};
+		REQUIRE(f.target<fsv::char_table>() != nullptr);
+		REQUIRE(f.table() == f.target<fsv::char_table>());
+		REQUIRE(*f.table() == no_spaces);
+		REQUIRE_FALSE(f(' '));
+
+		const auto g = fsv::filter{std::function<bool(const char &)>{[](const char &c){ return c == 'x'; }}};
+		REQUIRE(g.table() == nullptr);
+		REQUIRE(g.target<fsv::char_table>() == nullptr);
+		REQUIRE(g.target<std::function<bool(const char &)>>() != nullptr);
+		REQUIRE(g('x'));
+		REQUIRE_FALSE(g('y'));
+	}
+
+	SECTION("copies share the callable"){
+		struct counted {
+			explicit counted(int *copies) : copies_{copies} {}
+			counted(const counted &other) : copies_{other.copies_} {
+				++*copies_;
+			}
+			auto operator()(const char &c) const -> bool {
+				return c != ',';
+			}
+			int *copies_;
+		};
+		auto copies = 0;
+		auto sv = fsv::filtered_string_view{"a,b,c", fsv::filter{counted{&copies}}};
+		const auto before = copies;
+		auto copy = sv;
+		auto tokens = fsv::split(sv, fsv::filtered_string_view{"b"});
+		auto sub = fsv::substr(sv, 1);
+		REQUIRE(copies == before);
+		REQUIRE(copy.predicate().target<counted>() == sv.predicate().target<counted>());
+		REQUIRE(tokens.size() == 2);
+		REQUIRE(sub.size() == 2);
+	}
+
+	SECTION("moves leave a pass-through view behind"){
+		auto sv = fsv::filtered_string_view{"a,b", [](const char &c){ return c != ','; }};
+		auto moved = std::move(sv);
+		REQUIRE(moved.size() == 2);
+		REQUIRE(sv.predicate().target<fsv::pass_through>() != nullptr);
+		auto assigned = fsv::filtered_string_view{};
+		assigned = std::move(moved);
+		REQUIRE(static_cast<std::string>(assigned) == "ab");
+		REQUIRE(moved.predicate().target<fsv::pass_through>() != nullptr);
+	}
+}
+
+TEST_CASE("compose") {
+	using filter = std::function<bool(const char &)>;
+	const auto no_bangs = fsv::char_table{[](const char &c){ return c != '!'; }};
+	const auto no_spaces = fsv::char_table{[](const char &c){ return c != ' '; }};
+
+	SECTION("keeps the source length and predicate"){
+		const auto s = std::string{"a b!\0c d!", 9};
+		const auto sv = fsv::filtered_string_view{s.data(), s.size(), [](const char &c){ return c != 'a'; }};
+		const auto composed = fsv::compose(sv, {filter{no_bangs}});
+		REQUIRE(composed.data() == sv.data());
+		REQUIRE(composed.raw_size() == s.size());
+		REQUIRE(static_cast<std::string>(composed) == std::string{" b\0c d", 6});
+	}
+
+	SECTION("table filters fuse into one table"){
+		const auto sv = fsv::filtered_string_view{"j a v a ! c++!"};
+		const auto composed = fsv::compose(sv, {filter{no_bangs}, filter{no_spaces}});
+		REQUIRE(composed.predicate().table() != nullptr);
+		REQUIRE(*composed.predicate().table() == (no_bangs & no_spaces));
+		REQUIRE(static_cast<std::string>(composed) == "javac++");
+		const auto tabulated = fsv::tabulate(fsv::filtered_string_view{"a!b", [](const char &c){ return c != 'b'; }});
+		REQUIRE(fsv::compose(tabulated, {filter{no_bangs}}).predicate().table() != nullptr);
+	}
+
+	SECTION("nested composes flatten"){
+		auto calls = 0;
+		const auto sv = fsv::filtered_string_view{"a1 b2! c3"};
+		const auto inner = fsv::compose(sv, {[&calls](const char &c){ ++calls; return c < '0' || c > '9'; }, filter{no_bangs}});
+		const auto outer = fsv::compose(inner, {filter{no_spaces}, [](const char &c){ return c != 'c'; }});
+		REQUIRE(static_cast<std::string>(outer) == "ab");
+		REQUIRE(static_cast<std::string>(fsv::compose(outer, {})) == "ab");
+		// the digit filter runs only on chars the fused table keeps
+		calls = 0;
+		REQUIRE(outer.size() == 2);
+		REQUIRE(calls == 6);
+	}
+}
+
+TEST_CASE("pred") {
+	namespace pred = fsv::pred;
+
+	SECTION("combinators are constexpr tables"){
+		constexpr auto word = pred::or_(pred::alnum, pred::is('_'));
+		STATIC_REQUIRE(word('a') && word('Z') && word('7') && word('_'));
+		STATIC_REQUIRE_FALSE(word('-'));
+		STATIC_REQUIRE(pred::not_(pred::any_of(", ")) == pred::none_of(", "));
+		STATIC_REQUIRE(pred::and_(pred::alpha, pred::not_(pred::upper)) == pred::lower);
+		STATIC_REQUIRE(pred::xor_(pred::alnum, pred::alpha) == pred::digit);
+		STATIC_REQUIRE(pred::all.all());
+		STATIC_REQUIRE(pred::none.none());
+		STATIC_REQUIRE(pred::range('a', 'f').count() == 6);
+		STATIC_REQUIRE(pred::range('\x80', '\xff').count() == 128);
+		STATIC_REQUIRE(pred::range('z', 'a').none());
+		STATIC_REQUIRE(pred::xdigit.count() == 22);
+		STATIC_REQUIRE(pred::punct.count() == 32);
+		STATIC_REQUIRE((pred::print | pred::cntrl) == pred::range('\0', '\x7f'));
+		// plain predicates are tabulated
+		STATIC_REQUIRE(pred::and_(pred::lower, [](const char &c){ return c != 'x'; }).count() == 25);
+	}
+
+	SECTION("views keep the table fast path"){
+		const auto s = std::string{"id=42, name=Ragdoll; kind=cat"};
+		const auto sv = fsv::filtered_string_view{s, pred::or_(pred::alpha, pred::any_of(",;"))};
+		REQUIRE(sv.predicate().table() != nullptr);
+		REQUIRE(static_cast<std::string>(sv) == "id,nameRagdoll;kindcat");
+		const auto bv = fsv::basic_filtered_string_view{s, pred::digit};
+		REQUIRE(static_cast<std::string>(bv) == "42");
+	}
+}
+
+namespace {
+	constexpr auto keywords = fsv::basic_filtered_string_view{"if,  else, while,for", fsv::pred::none_of(" ")};
+
+	constexpr auto nth_keyword(std::size_t n) -> std::size_t {
+		const auto tokens = fsv::split(keywords, fsv::basic_filtered_string_view{",", fsv::pred::all});
+		return tokens[n].size();
+	}
+
+	constexpr auto count_upper(const char *s) -> int {
+		auto res = 0;
+		for (auto c : fsv::basic_filtered_string_view{s, [](const char &c){ return c >= 'A' && c <= 'Z'; }}) {
+			res += c != '\0' ? 1 : 0;
+		}
+		return res;
+	}
+}
+
+TEST_CASE("constexpr views") {
+	STATIC_REQUIRE(keywords.size() == 17);
+	STATIC_REQUIRE_FALSE(keywords.empty());
+	STATIC_REQUIRE(keywords[3] == 'e');
+	STATIC_REQUIRE(keywords == fsv::basic_filtered_string_view{"if,else,while,for", fsv::pred::all});
+	STATIC_REQUIRE(keywords > fsv::basic_filtered_string_view{"if,else,while,for,do", fsv::pred::all});
+	STATIC_REQUIRE(keywords.substr(3, 4) == fsv::basic_filtered_string_view{"else", fsv::pred::all});
+	STATIC_REQUIRE(nth_keyword(1) == 4);
+	STATIC_REQUIRE(nth_keyword(3) == 3);
+	STATIC_REQUIRE(static_cast<std::string>(keywords).size() == 17);
+	STATIC_REQUIRE(count_upper("HTTP/1.1 OK") == 6);
+	STATIC_REQUIRE(*--keywords.end() == 'r');
+
+	// the same views at runtime go through the kernels and agree
+	REQUIRE(keywords.size() == 17);
+	REQUIRE(static_cast<std::string>(keywords) == "if,else,while,for");
+}
@@ -0,0 +1,427 @@
+#include "./kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <immintrin.h>
+#	define FSV_KERNELS_X86 1
+#endif
+
+namespace fsv::detail {
+	namespace {
+		// below this many bytes building the shuffle tables costs more than it saves
+		constexpr std::size_t simd_min_bytes = 64;
+
+		auto count_scalar(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+			std::size_t res_ = 0;
+			for (std::size_t i = 0; i < n; ++i) {
+				res_ += table.test(p[i]) ? 1u : 0u;
+			}
+			return res_;
+		}
+
+		auto find_scalar(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+			for (std::size_t i = 0; i < n; ++i) {
+				if (table.test(p[i])) {
+					return i;
+				}
+			}
+			return n;
+		}
+
+		auto compact_scalar(const char *p, std::size_t n, const char_table &table, char *out) noexcept -> std::size_t {
+			std::size_t k = 0;
+			for (std::size_t i = 0; i < n; ++i) {
+				// store unconditionally and only advance on a kept byte; the slack takes the last store
+				out[k] = p[i];
+				k += table.test(p[i]) ? 1u : 0u;
+			}
+			return k;
+		}
+
+#ifdef FSV_KERNELS_X86
+		// compact_shuffles[m] gathers the bytes selected by the 8-bit mask m to the front
+		constexpr auto make_compact_shuffles() -> std::array<std::array<std::uint8_t, 8>, 256> {
+			std::array<std::array<std::uint8_t, 8>, 256> res_{};
+			for (unsigned m = 0; m < 256; ++m) {
+				unsigned k = 0;
+				for (unsigned b = 0; b < 8; ++b) {
+					if ((m >> b) & 1u) {
+						res_[m][k++] = static_cast<std::uint8_t>(b);
+					}
+				}
+				for (; k < 8; ++k) {
+					res_[m][k] = 0x80;
+				}
+			}
+			return res_;
+		}
+
+		constexpr auto compact_shuffles = make_compact_shuffles();
+
+		// pshufb operands for one char_table: bit (hi & 7) of row_lo[lo] / row_hi[lo] says
+		// whether byte (hi << 4 | lo) is kept, for hi < 8 / hi >= 8 respectively
+		struct nibble_tables {
+			alignas(16) std::uint8_t row_lo[16];
+			alignas(16) std::uint8_t row_hi[16];
+		};
+
+		auto make_nibble_tables(const char_table &table) noexcept -> nibble_tables {
+			nibble_tables res_{};
+			for (unsigned hi = 0; hi < 16; ++hi) {
+				for (unsigned lo = 0; lo < 16; ++lo) {
+					if (table.test(static_cast<char>(hi << 4 | lo))) {
+						auto &row_ = hi < 8 ? res_.row_lo : res_.row_hi;
+						row_[lo] = static_cast<std::uint8_t>(row_[lo] | 1u << (hi & 7u));
+					}
+				}
+			}
+			return res_;
+		}
+
+		// 0xff in every lane of x whose byte is kept
+		__attribute__((target("ssse3"))) inline auto classify_ssse3(__m128i x, __m128i row_lo, __m128i row_hi) noexcept
+		    -> __m128i {
+			const auto idx_mask_ = _mm_set1_epi8(static_cast<char>(0x8f));
+			// pshufb yields 0 for indices with bit 7 set, so each row only answers for its half
+			const auto lo_idx_ = _mm_and_si128(x, idx_mask_);
+			const auto hi_idx_ = _mm_and_si128(_mm_xor_si128(x, _mm_set1_epi8(static_cast<char>(0x80))), idx_mask_);
+			const auto row_ = _mm_or_si128(_mm_shuffle_epi8(row_lo, lo_idx_), _mm_shuffle_epi8(row_hi, hi_idx_));
+			const auto bit_lut_ = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const auto hi_ = _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0f));
+			const auto bit_ = _mm_shuffle_epi8(bit_lut_, hi_);
+			return _mm_cmpeq_epi8(_mm_and_si128(row_, bit_), bit_);
+		}
+
+		__attribute__((target("avx2"))) inline auto classify_avx2(__m256i x, __m256i row_lo, __m256i row_hi) noexcept
+		    -> __m256i {
+			const auto idx_mask_ = _mm256_set1_epi8(static_cast<char>(0x8f));
+			const auto lo_idx_ = _mm256_and_si256(x, idx_mask_);
+			const auto hi_idx_ = _mm256_and_si256(_mm256_xor_si256(x, _mm256_set1_epi8(static_cast<char>(0x80))), idx_mask_);
+			const auto row_ = _mm256_or_si256(_mm256_shuffle_epi8(row_lo, lo_idx_), _mm256_shuffle_epi8(row_hi, hi_idx_));
+			const auto bit_lut_ = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+			                                       1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const auto hi_ = _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0f));
+			const auto bit_ = _mm256_shuffle_epi8(bit_lut_, hi_);
+			return _mm256_cmpeq_epi8(_mm256_and_si256(row_, bit_), bit_);
+		}
+
+		// _mm512_broadcast_i32x4 trips -Wmaybe-uninitialized in GCC 12's headers at -O2
+		__attribute__((target("avx512f"))) inline auto broadcast_avx512(__m128i x) noexcept -> __m512i {
+			return _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff), x);
+		}
+
+		__attribute__((target("avx512f,avx512bw"))) inline auto classify_avx512(__m512i x, __m512i row_lo, __m512i row_hi) noexcept
+		    -> __mmask64 {
+			const auto idx_mask_ = _mm512_set1_epi8(static_cast<char>(0x8f));
+			const auto lo_idx_ = _mm512_and_si512(x, idx_mask_);
+			const auto hi_idx_ = _mm512_and_si512(_mm512_xor_si512(x, _mm512_set1_epi8(static_cast<char>(0x80))), idx_mask_);
+			const auto row_ = _mm512_or_si512(_mm512_shuffle_epi8(row_lo, lo_idx_), _mm512_shuffle_epi8(row_hi, hi_idx_));
+			const auto bit_lut_ = broadcast_avx512(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+			const auto hi_ = _mm512_and_si512(_mm512_srli_epi16(x, 4), _mm512_set1_epi8(0x0f));
+			const auto bit_ = _mm512_shuffle_epi8(bit_lut_, hi_);
+			return _mm512_test_epi8_mask(row_, bit_);
+		}
+
+		__attribute__((target("ssse3"))) auto count_ssse3(const char *p, std::size_t n, const char_table &table) noexcept
+		    -> std::size_t {
+			if (n < simd_min_bytes) {
+				return count_scalar(p, n, table);
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = _mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo));
+			const auto row_hi_ = _mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi));
+			const auto zero_ = _mm_setzero_si128();
+			auto sums_ = zero_;
+			std::size_t i = 0;
+			while (i + 16 <= n) {
+				// per-lane byte counters may take at most 255 hits before they are flushed
+				const auto stop_ = i + std::min<std::size_t>(255, (n - i) / 16) * 16;
+				auto counts_ = zero_;
+				for (; i < stop_; i += 16) {
+					const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+					counts_ = _mm_sub_epi8(counts_, classify_ssse3(x, row_lo_, row_hi_));
+				}
+				sums_ = _mm_add_epi64(sums_, _mm_sad_epu8(counts_, zero_));
+			}
+			alignas(16) std::uint64_t lanes_[2];
+			_mm_store_si128(reinterpret_cast<__m128i *>(lanes_), sums_);
+			return static_cast<std::size_t>(lanes_[0] + lanes_[1]) + count_scalar(p + i, n - i, table);
+		}
+
+		__attribute__((target("ssse3"))) auto find_ssse3(const char *p, std::size_t n, const char_table &table) noexcept
+		    -> std::size_t {
+			// hits close to the start (run boundaries, say) are common, and cheaper to find than
+			// the shuffle tables are to build
+			const auto head_ = find_scalar(p, std::min(n, simd_min_bytes), table);
+			if (head_ < simd_min_bytes || n == simd_min_bytes) {
+				return head_;
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = _mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo));
+			const auto row_hi_ = _mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi));
+			std::size_t i = simd_min_bytes;
+			for (; i + 16 <= n; i += 16) {
+				const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+				const auto mask_ = static_cast<unsigned>(_mm_movemask_epi8(classify_ssse3(x, row_lo_, row_hi_)));
+				if (mask_ != 0) {
+					return i + static_cast<std::size_t>(std::countr_zero(mask_));
+				}
+			}
+			return i + find_scalar(p + i, n - i, table);
+		}
+
+		__attribute__((target("avx2"))) auto count_avx2(const char *p, std::size_t n, const char_table &table) noexcept
+		    -> std::size_t {
+			if (n < simd_min_bytes) {
+				return count_scalar(p, n, table);
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo)));
+			const auto row_hi_ = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi)));
+			const auto zero_ = _mm256_setzero_si256();
+			auto sums_ = zero_;
+			std::size_t i = 0;
+			while (i + 32 <= n) {
+				const auto stop_ = i + std::min<std::size_t>(255, (n - i) / 32) * 32;
+				auto counts_ = zero_;
+				for (; i < stop_; i += 32) {
+					const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+					counts_ = _mm256_sub_epi8(counts_, classify_avx2(x, row_lo_, row_hi_));
+				}
+				sums_ = _mm256_add_epi64(sums_, _mm256_sad_epu8(counts_, zero_));
+			}
+			alignas(32) std::uint64_t lanes_[4];
+			_mm256_store_si256(reinterpret_cast<__m256i *>(lanes_), sums_);
+			return static_cast<std::size_t>(lanes_[0] + lanes_[1] + lanes_[2] + lanes_[3])
+			       + count_scalar(p + i, n - i, table);
+		}
+
+		__attribute__((target("avx2"))) auto find_avx2(const char *p, std::size_t n, const char_table &table) noexcept
+		    -> std::size_t {
+			// hits close to the start (run boundaries, say) are common, and cheaper to find than
+			// the shuffle tables are to build
+			const auto head_ = find_scalar(p, std::min(n, simd_min_bytes), table);
+			if (head_ < simd_min_bytes || n == simd_min_bytes) {
+				return head_;
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo)));
+			const auto row_hi_ = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi)));
+			std::size_t i = simd_min_bytes;
+			for (; i + 32 <= n; i += 32) {
+				const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+				const auto mask_ = static_cast<unsigned>(_mm256_movemask_epi8(classify_avx2(x, row_lo_, row_hi_)));
+				if (mask_ != 0) {
+					return i + static_cast<std::size_t>(std::countr_zero(mask_));
+				}
+			}
+			return i + find_scalar(p + i, n - i, table);
+		}
+		__attribute__((target("avx2,popcnt"))) auto compact_avx2(const char *p, std::size_t n, const char_table &table, char *out) noexcept
+		    -> std::size_t {
+			if (n < simd_min_bytes) {
+				return compact_scalar(p, n, table, out);
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo)));
+			const auto row_hi_ = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi)));
+			std::size_t i = 0;
+			std::size_t k = 0;
+			std::size_t run_ = 0; // start of the pending run of fully kept blocks
+			for (; i + 32 <= n; i += 32) {
+				const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+				const auto mask_ = static_cast<unsigned>(_mm256_movemask_epi8(classify_avx2(x, row_lo_, row_hi_)));
+				if (mask_ == 0xffffffffu) {
+					continue;
+				}
+				std::memcpy(out + k, p + run_, i - run_);
+				k += i - run_;
+				run_ = i + 32;
+				for (unsigned g = 0; mask_ != 0 && g < 4; ++g) {
+					const auto m8_ = (mask_ >> (8 * g)) & 0xffu;
+					const auto src_ = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + i + 8 * g));
+					const auto idx_ = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(compact_shuffles[m8_].data()));
+					_mm_storel_epi64(reinterpret_cast<__m128i *>(out + k), _mm_shuffle_epi8(src_, idx_));
+					k += static_cast<std::size_t>(std::popcount(m8_));
+				}
+			}
+			std::memcpy(out + k, p + run_, i - run_);
+			k += i - run_;
+			return k + compact_scalar(p + i, n - i, table, out + k);
+		}
+
+		__attribute__((target("avx512f,avx512bw,popcnt"))) auto count_avx512(const char *p, std::size_t n, const char_table &table) noexcept
+		    -> std::size_t {
+			if (n < simd_min_bytes) {
+				return count_scalar(p, n, table);
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = broadcast_avx512(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo)));
+			const auto row_hi_ = broadcast_avx512(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi)));
+			std::size_t res_ = 0;
+			std::size_t i = 0;
+			for (; i + 64 <= n; i += 64) {
+				const auto mask_ = classify_avx512(_mm512_loadu_si512(p + i), row_lo_, row_hi_);
+				res_ += static_cast<std::size_t>(std::popcount(static_cast<std::uint64_t>(mask_)));
+			}
+			return res_ + count_scalar(p + i, n - i, table);
+		}
+
+		__attribute__((target("avx512f,avx512bw"))) auto find_avx512(const char *p, std::size_t n, const char_table &table) noexcept
+		    -> std::size_t {
+			// hits close to the start (run boundaries, say) are common, and cheaper to find than
+			// the shuffle tables are to build
+			const auto head_ = find_scalar(p, std::min(n, simd_min_bytes), table);
+			if (head_ < simd_min_bytes || n == simd_min_bytes) {
+				return head_;
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = broadcast_avx512(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo)));
+			const auto row_hi_ = broadcast_avx512(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi)));
+			std::size_t i = simd_min_bytes;
+			for (; i + 64 <= n; i += 64) {
+				const auto mask_ = classify_avx512(_mm512_loadu_si512(p + i), row_lo_, row_hi_);
+				if (mask_ != 0) {
+					return i + static_cast<std::size_t>(std::countr_zero(static_cast<std::uint64_t>(mask_)));
+				}
+			}
+			return i + find_scalar(p + i, n - i, table);
+		}
+
+		// vpcompressb packs the kept bytes of a 64-byte block in one instruction
+		__attribute__((target("avx512f,avx512bw,avx512vbmi2,popcnt"))) auto compact_avx512(const char *p, std::size_t n, const char_table &table, char *out) noexcept
+		    -> std::size_t {
+			if (n < simd_min_bytes) {
+				return compact_scalar(p, n, table, out);
+			}
+			const auto tables_ = make_nibble_tables(table);
+			const auto row_lo_ = broadcast_avx512(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_lo)));
+			const auto row_hi_ = broadcast_avx512(_mm_load_si128(reinterpret_cast<const __m128i *>(tables_.row_hi)));
+			std::size_t i = 0;
+			std::size_t k = 0;
+			std::size_t run_ = 0; // start of the pending run of fully kept blocks
+			for (; i + 64 <= n; i += 64) {
+				const auto x = _mm512_loadu_si512(p + i);
+				const auto mask_ = classify_avx512(x, row_lo_, row_hi_);
+				if (mask_ == ~__mmask64{0}) {
+					continue;
+				}
+				std::memcpy(out + k, p + run_, i - run_);
+				k += i - run_;
+				run_ = i + 64;
+				if (mask_ != 0) {
+					_mm512_storeu_si512(out + k, _mm512_maskz_compress_epi8(mask_, x));
+					k += static_cast<std::size_t>(std::popcount(static_cast<std::uint64_t>(mask_)));
+				}
+			}
+			std::memcpy(out + k, p + run_, i - run_);
+			k += i - run_;
+			return k + compact_scalar(p + i, n - i, table, out + k);
+		}
+#endif
+
+		// the "keep everything" and "keep nothing" tables need no scan at all
+		template<auto Kernel, bool IsFind>
+		auto with_trivial_tables(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+			if (table.none()) {
+				return IsFind ? n : 0;
+			}
+			if (table.all()) {
+				return IsFind ? 0 : n;
+			}
+			return Kernel(p, n, table);
+		}
+
+		template<auto Kernel>
+		auto with_trivial_tables(const char *p, std::size_t n, const char_table &table, char *out) noexcept -> std::size_t {
+			if (table.none()) {
+				return 0;
+			}
+			if (table.all()) {
+				std::memcpy(out, p, n);
+				return n;
+			}
+			return Kernel(p, n, table, out);
+		}
+
+		// the first dropped byte is the first byte the complement keeps
+		template<auto Find>
+		auto complemented(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+			return Find(p, n, ~table);
+		}
+
+		constexpr byte_kernels scalar_kernels{
+		    with_trivial_tables<count_scalar, false>, with_trivial_tables<find_scalar, true>,
+		    complemented<with_trivial_tables<find_scalar, true>>, with_trivial_tables<compact_scalar>};
+#ifdef FSV_KERNELS_X86
+		// SSSE3 has no cheap variable byte compaction, so it keeps the scalar compact
+		constexpr byte_kernels ssse3_kernels{
+		    with_trivial_tables<count_ssse3, false>, with_trivial_tables<find_ssse3, true>,
+		    complemented<with_trivial_tables<find_ssse3, true>>, with_trivial_tables<compact_scalar>};
+		constexpr byte_kernels avx2_kernels{
+		    with_trivial_tables<count_avx2, false>, with_trivial_tables<find_avx2, true>,
+		    complemented<with_trivial_tables<find_avx2, true>>, with_trivial_tables<compact_avx2>};
+		// count and find need only AVX512BW; compact_avx512 needs VBMI2 as well
+		constexpr byte_kernels avx512bw_kernels{
+		    with_trivial_tables<count_avx512, false>, with_trivial_tables<find_avx512, true>,
+		    complemented<with_trivial_tables<find_avx512, true>>, with_trivial_tables<compact_avx2>};
+		constexpr byte_kernels avx512_kernels{
+		    with_trivial_tables<count_avx512, false>, with_trivial_tables<find_avx512, true>,
+		    complemented<with_trivial_tables<find_avx512, true>>, with_trivial_tables<compact_avx512>};
+#endif
+	}
+
+	auto isa_supported(isa level) noexcept -> bool {
+#ifdef FSV_KERNELS_X86
+		switch (level) {
+		case isa::scalar: return true;
+		case isa::ssse3: return __builtin_cpu_supports("ssse3") != 0;
+		case isa::avx2: return __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("popcnt") != 0;
+		case isa::avx512bw:
+			return __builtin_cpu_supports("avx512f") != 0 && __builtin_cpu_supports("avx512bw") != 0
+			       && isa_supported(isa::avx2);
+		case isa::avx512vbmi2: return isa_supported(isa::avx512bw) && __builtin_cpu_supports("avx512vbmi2") != 0;
+		}
+		return false;
+#else
+		return level == isa::scalar;
+#endif
+	}
+
+	auto best_isa() noexcept -> isa {
+		static const auto best_ = [] {
+			for (auto level : {isa::avx512vbmi2, isa::avx512bw, isa::avx2, isa::ssse3}) {
+				if (isa_supported(level)) {
+					return level;
+				}
+			}
+			return isa::scalar;
+		}();
+		return best_;
+	}
+
+	auto kernels(isa level) noexcept -> const byte_kernels & {
+#ifdef FSV_KERNELS_X86
+		switch (level) {
+		case isa::scalar: return scalar_kernels;
+		case isa::ssse3: return ssse3_kernels;
+		case isa::avx2: return avx2_kernels;
+		case isa::avx512bw: return avx512bw_kernels;
+		case isa::avx512vbmi2: return avx512_kernels;
+		}
+#else
+		static_cast<void>(level);
+#endif
+		return scalar_kernels;
+	}
+
+	auto kernels() noexcept -> const byte_kernels & {
+		static const auto &best_ = kernels(best_isa());
+		return best_;
+	}
+}
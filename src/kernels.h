@@ -0,0 +1,64 @@
+#ifndef COMP6771_ASS2_KERNELS_H
+#define COMP6771_ASS2_KERNELS_H
+
+#include "./char_table.h"
+#include "./stats.h"
+
+#include <cstddef>
+
+// Bulk byte-classification kernels for char_table predicates.
+// Each kernel has a scalar version and, on x86, SIMD versions that classify 16 (SSSE3),
+// 32 (AVX2) or 64 (AVX-512) bytes per step with a pshufb nibble lookup; the best one the
+// CPU supports is picked at runtime.
+namespace fsv::detail {
+	// avx512bw counts and finds with AVX-512 but compacts with AVX2, which needs no VBMI2
+	enum class isa { scalar, ssse3, avx2, avx512bw, avx512vbmi2 };
+
+	// extra bytes compact() may scribble past the kept bytes it writes
+	inline constexpr std::size_t compact_slack = 64;
+
+	struct byte_kernels {
+		// number of bytes in [p, p + n) kept by table
+		std::size_t (*count)(const char *p, std::size_t n, const char_table &table) noexcept;
+		// offset of the first byte in [p, p + n) kept by table, or n if there is none
+		std::size_t (*find)(const char *p, std::size_t n, const char_table &table) noexcept;
+		// offset of the first byte in [p, p + n) dropped by table, or n if there is none
+		std::size_t (*find_not)(const char *p, std::size_t n, const char_table &table) noexcept;
+		// copies the bytes in [p, p + n) kept by table to out and returns how many there were;
+		// out must have room for that many bytes plus compact_slack
+		std::size_t (*compact)(const char *p, std::size_t n, const char_table &table, char *out) noexcept;
+	};
+
+	// the widest instruction set usable on this CPU
+	[[nodiscard]] auto best_isa() noexcept -> isa;
+	[[nodiscard]] auto isa_supported(isa level) noexcept -> bool;
+	// kernels for level, which must be supported
+	[[nodiscard]] auto kernels(isa level) noexcept -> const byte_kernels &;
+	// kernels for best_isa()
+	[[nodiscard]] auto kernels() noexcept -> const byte_kernels &;
+
+	[[nodiscard]] inline auto count_kept(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+		stats::note_bytes_scanned(n);
+		return kernels().count(p, n, table);
+	}
+
+	[[nodiscard]] inline auto find_kept(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+		const auto res_ = kernels().find(p, n, table);
+		stats::note_bytes_scanned(res_ < n ? res_ + 1 : n);
+		return res_;
+	}
+
+	[[nodiscard]] inline auto find_not_kept(const char *p, std::size_t n, const char_table &table) noexcept -> std::size_t {
+		const auto res_ = kernels().find_not(p, n, table);
+		stats::note_bytes_scanned(res_ < n ? res_ + 1 : n);
+		return res_;
+	}
+
+	[[nodiscard]] inline auto compact_kept(const char *p, std::size_t n, const char_table &table, char *out) noexcept
+	    -> std::size_t {
+		stats::note_bytes_scanned(n);
+		return kernels().compact(p, n, table, out);
+	}
+}
+
+#endif // COMP6771_ASS2_KERNELS_H
@@ -0,0 +1,131 @@
+#include "./kernels.h"
+#include "./filtered_string_view.h"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	auto random_bytes(std::size_t n, unsigned seed) -> std::string {
+		auto gen = std::mt19937{seed};
+		auto dist = std::uniform_int_distribution<int>{0, 255};
+		auto s = std::string(n, '\0');
+		for (auto &c : s) {
+			c = static_cast<char>(dist(gen));
+		}
+		return s;
+	}
+
+	auto supported_isas() -> std::vector<fsv::detail::isa> {
+		auto res = std::vector<fsv::detail::isa>{};
+		for (auto level : {fsv::detail::isa::scalar, fsv::detail::isa::ssse3, fsv::detail::isa::avx2,
+		                   fsv::detail::isa::avx512bw, fsv::detail::isa::avx512vbmi2}) {
+			if (fsv::detail::isa_supported(level)) {
+				res.push_back(level);
+			}
+		}
+		return res;
+	}
+
+	const auto tables = std::vector<fsv::char_table>{
+		fsv::char_table{},
+		fsv::char_table{fsv::pass_through{}},
+		fsv::char_table{[](const char &c){ return c == ','; }},
+		fsv::char_table{[](const char &c){ return c >= 'a' && c <= 'z'; }},
+		fsv::char_table{[](const char &c){ return static_cast<unsigned char>(c) >= 0x80; }},
+		fsv::char_table{[](const char &c){ return (static_cast<unsigned char>(c) * 37u) % 5u < 2u; }},
+	};
+}
+
+TEST_CASE("count kernels agree with the table") {
+	REQUIRE(fsv::detail::isa_supported(fsv::detail::isa::scalar));
+	const auto s = random_bytes(10000, 42);
+	for (auto level : supported_isas()) {
+		const auto &k = fsv::detail::kernels(level);
+		for (const auto &table : tables) {
+			for (auto n : {std::size_t{0}, std::size_t{15}, std::size_t{64}, std::size_t{100}, std::size_t{8191}, s.size()}) {
+				for (auto offset : {std::size_t{0}, std::size_t{3}}) {
+					if (offset + n > s.size()) {
+						continue;
+					}
+					std::size_t expected = 0;
+					for (std::size_t i = 0; i < n; ++i) {
+						expected += table.test(s[offset + i]) ? 1u : 0u;
+					}
+					REQUIRE(k.count(s.data() + offset, n, table) == expected);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("find kernels agree with the table") {
+	auto s = std::string(5000, 'x');
+	const auto comma = fsv::char_table{[](const char &c){ return c == ','; }};
+	for (auto level : supported_isas()) {
+		const auto &k = fsv::detail::kernels(level);
+		REQUIRE(k.find(s.data(), s.size(), comma) == s.size());
+		for (auto pos : {std::size_t{0}, std::size_t{31}, std::size_t{32}, std::size_t{1000}, std::size_t{4999}}) {
+			auto t = s;
+			t[pos] = ',';
+			t[4999] = ',';
+			REQUIRE(k.find(t.data(), t.size(), comma) == pos);
+		}
+	}
+}
+
+TEST_CASE("find_not kernels agree with the table") {
+	auto s = std::string(5000, ',');
+	const auto comma = fsv::char_table{[](const char &c){ return c == ','; }};
+	for (auto level : supported_isas()) {
+		const auto &k = fsv::detail::kernels(level);
+		REQUIRE(k.find_not(s.data(), s.size(), comma) == s.size());
+		REQUIRE(k.find_not(s.data(), s.size(), fsv::char_table{}) == 0);
+		REQUIRE(k.find_not(s.data(), s.size(), ~fsv::char_table{}) == s.size());
+		for (auto pos : {std::size_t{0}, std::size_t{31}, std::size_t{32}, std::size_t{1000}, std::size_t{4999}}) {
+			auto t = s;
+			t[pos] = 'x';
+			t[4999] = 'x';
+			REQUIRE(k.find_not(t.data(), t.size(), comma) == pos);
+		}
+	}
+}
+
+TEST_CASE("compact kernels keep exactly the kept bytes") {
+	auto s = random_bytes(10000, 3);
+	// long fully kept stretches exercise the bulk-copy path
+	for (std::size_t i = 1000; i < 3000; ++i) {
+		s[i] = 'k';
+	}
+	for (auto level : supported_isas()) {
+		const auto &k = fsv::detail::kernels(level);
+		for (const auto &table : tables) {
+			for (auto n : {std::size_t{0}, std::size_t{15}, std::size_t{64}, std::size_t{100}, std::size_t{8191}, s.size()}) {
+				auto expected = std::string{};
+				for (std::size_t i = 0; i < n; ++i) {
+					if (table.test(s[i])) {
+						expected += s[i];
+					}
+				}
+				auto out = std::string(expected.size() + fsv::detail::compact_slack, '\0');
+				REQUIRE(k.compact(s.data(), n, table, out.data()) == expected.size());
+				out.resize(expected.size());
+				REQUIRE(out == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("views with table predicates use the kernels") {
+	const auto s = random_bytes(4096, 7);
+	const auto lower = [](const char &c){ return c >= 'a' && c <= 'z'; };
+	const auto sv = fsv::filtered_string_view{s, lower};
+	const auto tv = fsv::tabulate(sv);
+	REQUIRE(tv.size() == sv.size());
+	REQUIRE(fsv::filtered_string_view{s, fsv::char_table{}}.empty());
+	REQUIRE_FALSE(tv.empty());
+	REQUIRE(fsv::basic_filtered_string_view{s, fsv::char_table{lower}}.size() == sv.size());
+	REQUIRE(static_cast<std::string>(tv) == static_cast<std::string>(sv));
+	REQUIRE(static_cast<std::string>(fsv::tabulate(fsv::filtered_string_view{s})) == s);
+}
@@ -0,0 +1,122 @@
+#include "./mapped_file.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fsv {
+	namespace {
+		[[noreturn]] auto throw_errno(const std::string &what) -> void {
+			throw std::system_error{errno, std::generic_category(), what};
+		}
+
+		auto to_madvise(mapped_file::advice a) noexcept -> int {
+			switch (a) {
+			case mapped_file::advice::normal: return MADV_NORMAL;
+			case mapped_file::advice::sequential: return MADV_SEQUENTIAL;
+			case mapped_file::advice::random: return MADV_RANDOM;
+			case mapped_file::advice::willneed: return MADV_WILLNEED;
+			case mapped_file::advice::hugepage:
+#ifdef MADV_HUGEPAGE
+				return MADV_HUGEPAGE;
+#else
+				return -1;
+#endif
+			}
+			return -1;
+		}
+	}
+
+	mapped_file::mapped_file(const std::string &path) {
+		const auto fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd_ < 0) {
+			throw_errno("fsv::mapped_file: open " + path);
+		}
+		struct stat st_{};
+		if (::fstat(fd_, &st_) != 0) {
+			const auto err_ = errno;
+			::close(fd_);
+			errno = err_;
+			throw_errno("fsv::mapped_file: stat " + path);
+		}
+		size_ = static_cast<std::size_t>(st_.st_size);
+		// mmap refuses empty mappings, and an empty file needs none
+		if (size_ > 0) {
+			auto *addr_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+			if (addr_ == MAP_FAILED) {
+				const auto err_ = errno;
+				::close(fd_);
+				errno = err_;
+				throw_errno("fsv::mapped_file: mmap " + path);
+			}
+			data_ = static_cast<const char *>(addr_);
+		}
+		// the mapping keeps the file alive
+		::close(fd_);
+	}
+
+	mapped_file::mapped_file(mapped_file &&other) noexcept
+	: data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+	auto mapped_file::operator=(mapped_file &&other) noexcept -> mapped_file & {
+		if (this != &other) {
+			release_();
+			data_ = std::exchange(other.data_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	mapped_file::~mapped_file() {
+		release_();
+	}
+
+	auto mapped_file::release_() noexcept -> void {
+		if (data_ != nullptr) {
+			::munmap(const_cast<char *>(data_), size_);
+		}
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	auto mapped_file::data() const noexcept -> const char * {
+		return data_;
+	}
+
+	auto mapped_file::size() const noexcept -> std::size_t {
+		return size_;
+	}
+
+	auto mapped_file::empty() const noexcept -> bool {
+		return size_ == 0;
+	}
+
+	auto mapped_file::advise(advice a) const noexcept -> bool {
+		const auto advice_ = to_madvise(a);
+		if (advice_ < 0) {
+			return false;
+		}
+		if (data_ == nullptr) {
+			return true; // nothing mapped to advise on
+		}
+		return ::madvise(const_cast<char *>(data_), size_, advice_) == 0;
+	}
+
+	auto mapped_file::view(filter pred) const noexcept -> filtered_string_view {
+		return filtered_string_view{data_, size_, std::move(pred)};
+	}
+
+	auto mapped_file::view(std::size_t offset, std::size_t size, filter pred) const -> filtered_string_view {
+		if (offset > size_ || size > size_ - offset) {
+			throw std::domain_error{"mapped_file::view(" + std::to_string(offset) + ", " + std::to_string(size)
+			                        + "): invalid range"};
+		}
+		return filtered_string_view{data_ + offset, size, std::move(pred)};
+	}
+}
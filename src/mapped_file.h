@@ -0,0 +1,48 @@
+#ifndef COMP6771_ASS2_MAPPED_FILE_H
+#define COMP6771_ASS2_MAPPED_FILE_H
+
+#include "./filtered_string_view.h"
+
+#include <cstddef>
+#include <string>
+
+namespace fsv {
+	// A file mapped read-only into memory, as a source of views too large to read in.
+	// Pages are loaded by the kernel as views touch them; advise() tells it how they will be.
+	// Views handed out point into the mapping and must not outlive it.
+	class mapped_file {
+	 public:
+		// hints for madvise
+		enum class advice { normal, sequential, random, willneed, hugepage };
+
+		mapped_file() noexcept = default;
+		// Throws std::system_error if path cannot be opened or mapped.
+		explicit mapped_file(const std::string &path);
+		mapped_file(mapped_file &&other) noexcept;
+		auto operator=(mapped_file &&other) noexcept -> mapped_file &;
+		mapped_file(const mapped_file &) = delete;
+		auto operator=(const mapped_file &) -> mapped_file & = delete;
+		~mapped_file();
+
+		[[nodiscard]] auto data() const noexcept -> const char *;
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+		[[nodiscard]] auto empty() const noexcept -> bool;
+
+		// Passes a hint on to the kernel for the whole mapping; whether it was accepted (e.g.
+		// hugepage is refused by kernels without transparent huge pages for files).
+		auto advise(advice a) const noexcept -> bool;
+
+		// The whole file, or size bytes of it from offset, filtered by pred.
+		// Throws std::domain_error if the range is not within the file.
+		[[nodiscard]] auto view(filter pred = {}) const noexcept -> filtered_string_view;
+		[[nodiscard]] auto view(std::size_t offset, std::size_t size, filter pred = {}) const -> filtered_string_view;
+
+	 private:
+		auto release_() noexcept -> void;
+
+		const char *data_{nullptr};
+		std::size_t size_{0};
+	};
+}
+
+#endif // COMP6771_ASS2_MAPPED_FILE_H
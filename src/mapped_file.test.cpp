@@ -0,0 +1,104 @@
+#include "./mapped_file.h"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace {
+	// a file in the temp directory holding contents, removed again on destruction
+	class temp_file {
+	 public:
+		explicit temp_file(const std::string &contents)
+		: path_{std::filesystem::temp_directory_path() / ("fsv_mapped_file_" + std::to_string(reinterpret_cast<std::uintptr_t>(this)))} {
+			auto out = std::ofstream{path_, std::ios::binary};
+			out << contents;
+		}
+		temp_file(const temp_file &) = delete;
+		auto operator=(const temp_file &) -> temp_file & = delete;
+		~temp_file() {
+			std::filesystem::remove(path_);
+		}
+
+		[[nodiscard]] auto path() const -> std::string {
+			return path_.string();
+		}
+
+	 private:
+		std::filesystem::path path_;
+	};
+}
+
+TEST_CASE("mapped_file") {
+	auto not_digit = [](const char &c){ return c < '0' || c > '9'; };
+
+	SECTION("views over the whole file") {
+		auto contents = std::string{};
+		for (auto i = 0; i < 10000; ++i) {
+			contents += "line " + std::to_string(i) + '\n';
+		}
+		const auto file = temp_file{contents};
+		const auto mapped = fsv::mapped_file{file.path()};
+		REQUIRE(mapped.size() == contents.size());
+		REQUIRE(std::string{mapped.data(), mapped.size()} == contents);
+		REQUIRE(mapped.view().size() == contents.size());
+		REQUIRE(mapped.view() == fsv::filtered_string_view{contents});
+		REQUIRE(mapped.view(not_digit).size() == 60000);
+		REQUIRE(mapped.view(fsv::char_table{not_digit}) == mapped.view(not_digit));
+	}
+
+	SECTION("views over part of the file") {
+		const auto file = temp_file{"ab12cd34ef"};
+		const auto mapped = fsv::mapped_file{file.path()};
+		REQUIRE(mapped.view(2, 6, not_digit) == fsv::filtered_string_view{"cd"});
+		REQUIRE(mapped.view(10, 0).empty());
+		REQUIRE_THROWS_AS(mapped.view(11, 0), std::domain_error);
+		REQUIRE_THROWS_AS(mapped.view(4, 7), std::domain_error);
+	}
+
+	SECTION("embedded null chars are part of the file") {
+		const auto contents = std::string{"a\0b\0c", 5};
+		const auto file = temp_file{contents};
+		const auto mapped = fsv::mapped_file{file.path()};
+		REQUIRE(mapped.view().size() == 5);
+		REQUIRE(static_cast<std::string>(mapped.view([](const char &c){ return c != '\0'; })) == "abc");
+	}
+
+	SECTION("advice") {
+		const auto file = temp_file{std::string(1 << 16, 'x')};
+		const auto mapped = fsv::mapped_file{file.path()};
+		REQUIRE(mapped.advise(fsv::mapped_file::advice::sequential));
+		REQUIRE(mapped.advise(fsv::mapped_file::advice::willneed));
+		REQUIRE(mapped.advise(fsv::mapped_file::advice::normal));
+		// hugepage depends on the kernel, but must not break the mapping
+		static_cast<void>(mapped.advise(fsv::mapped_file::advice::hugepage));
+		REQUIRE(mapped.view().size() == 1 << 16);
+	}
+
+	SECTION("empty files") {
+		const auto file = temp_file{""};
+		const auto mapped = fsv::mapped_file{file.path()};
+		REQUIRE(mapped.empty());
+		REQUIRE(mapped.view().empty());
+		REQUIRE(mapped.advise(fsv::mapped_file::advice::sequential));
+	}
+
+	SECTION("moves hand over the mapping") {
+		const auto file = temp_file{"abc"};
+		auto mapped = fsv::mapped_file{file.path()};
+		const auto *data = mapped.data();
+		auto other = std::move(mapped);
+		REQUIRE(other.data() == data);
+		REQUIRE(mapped.empty());
+		mapped = std::move(other);
+		REQUIRE(mapped.view() == fsv::filtered_string_view{"abc"});
+	}
+
+	SECTION("missing files throw") {
+		REQUIRE_THROWS_AS(fsv::mapped_file{"/nonexistent/fsv/file"}, std::system_error);
+	}
+}
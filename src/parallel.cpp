@@ -0,0 +1,375 @@
+#include "./parallel.h"
+
+#include "./kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <optional>
+#include <string_view>
+
+namespace fsv::par {
+	namespace {
+		// smallest chunk worth handing to another thread
+		constexpr std::size_t min_chunk = std::size_t{1} << 18;
+		// chunks per thread, so that threads finishing early can take up the slack of others
+		constexpr std::size_t chunks_per_thread = 4;
+		// raw bytes compacted at a time; the compacted bytes of a block go through a buffer of
+		// this size whenever the kernel's slack could reach into the next chunk's output
+		constexpr std::size_t block_size = std::size_t{1} << 14;
+
+		// chunk length for a view of len raw chars, a multiple of 64; len if it is not worth splitting
+		auto chunk_size(std::size_t len, const thread_pool &pool) -> std::size_t {
+			if (pool.size() == 1 || len < 2 * min_chunk) {
+				return len;
+			}
+			const auto chunks_ = std::min(len / min_chunk, pool.size() * chunks_per_thread);
+			return (len / chunks_ + 63) / 64 * 64;
+		}
+
+		auto chunk_count(std::size_t len, std::size_t chunk) -> std::size_t {
+			return (len + chunk - 1) / chunk;
+		}
+
+		auto chunk(const filtered_string_view &fsv, std::size_t size, std::size_t i) -> filtered_string_view {
+			const auto first_ = i * size;
+			return filtered_string_view{fsv.data() + first_, std::min(size, fsv.raw_size() - first_), fsv.predicate()};
+		}
+
+		// the kept chars of each chunk
+		auto count_chunks(const filtered_string_view &fsv, std::size_t size, thread_pool &pool) -> std::vector<std::size_t> {
+			auto counts_ = std::vector<std::size_t>(chunk_count(fsv.raw_size(), size));
+			pool.for_each_index(counts_.size(), [&](std::size_t i) {
+				counts_[i] = chunk(fsv, size, i).size();
+			});
+			return counts_;
+		}
+
+		// Compacts the kept chars of raw [p, p + n) into [out, out_end), which they fill exactly
+		// but for any slack after the last chunk.
+		auto compact_chunk(const char *p, std::size_t n, const char_table &table, char *out, const char *out_end) -> void {
+			auto buf_ = std::array<char, block_size + detail::compact_slack>{};
+			for (std::size_t pos = 0; pos < n; pos += block_size) {
+				const auto len_ = std::min(block_size, n - pos);
+				if (static_cast<std::size_t>(out_end - out) >= len_ + detail::compact_slack) {
+					out += detail::compact_kept(p + pos, len_, table, out);
+				}
+				else {
+					const auto kept_ = detail::compact_kept(p + pos, len_, table, buf_.data());
+					std::memcpy(out, buf_.data(), kept_);
+					out += kept_;
+				}
+			}
+		}
+
+		// a delimiter match, from the raw offset of its first kept char to past its last
+		struct match {
+			std::size_t first;
+			std::size_t last;
+			// picked by split(); until the chunks are reconciled, by a split() starting at the chunk
+			bool picked;
+		};
+
+		struct chunk_matches {
+			std::vector<match> matches;
+			std::size_t picked = 0; // matches picked by the chunk's own split()
+			std::size_t end = 0;    // past the last of them
+		};
+
+		// Every match of delim over the kept chars of fsv that starts in the chunk at raw
+		// [first, last), overlapping ones included; the scan goes on past last only as long as
+		// the partial match in hand started before it.
+		template<typename P>
+		auto find_matches(const filtered_string_view &fsv, const std::string &delim, const std::vector<std::size_t> &fail,
+		                  std::size_t first, std::size_t last, const P &pred) -> chunk_matches {
+			auto res_ = chunk_matches{};
+			const auto *ptr_ = fsv.data();
+			const auto m_ = delim.size();
+			if (m_ == 1) {
+				if (pred(delim[0])) {
+					const char *hit_;
+					for (auto i = first; (hit_ = std::char_traits<char>::find(ptr_ + i, last - i, delim[0])) != nullptr; ) {
+						i = static_cast<std::size_t>(hit_ - ptr_) + 1;
+						res_.matches.push_back({i - 1, i, false});
+					}
+				}
+			}
+			else {
+				std::size_t k = 0;
+				std::size_t past_ = 0; // kept chars at or after last
+				for (auto i = first; i < fsv.raw_size() && (i < last || k > past_); ++i) {
+					if (!pred(ptr_[i])) {
+						continue;
+					}
+					past_ += i >= last;
+					while (k > 0 && ptr_[i] != delim[k]) {
+						k = fail[k - 1];
+					}
+					if (ptr_[i] == delim[k]) {
+						++k;
+					}
+					if (k == m_) {
+						auto start_ = i;
+						for (std::size_t kept_ = 1; kept_ < m_; ) {
+							--start_;
+							if (pred(ptr_[start_])) {
+								++kept_;
+							}
+						}
+						if (start_ < last) {
+							res_.matches.push_back({start_, i + 1, false});
+						}
+						k = fail[k - 1];
+					}
+				}
+			}
+			// the leftmost non-overlapping matches, as if split() started at first
+			res_.end = first;
+			for (auto &m : res_.matches) {
+				m.picked = m.first >= res_.end;
+				if (m.picked) {
+					res_.end = m.last;
+					++res_.picked;
+				}
+			}
+			return res_;
+		}
+	}
+
+	struct thread_pool::job {
+		job(std::size_t n, const std::function<void(std::size_t)> &f) : n{n}, f{f} {}
+
+		const std::size_t n;
+		const std::function<void(std::size_t)> &f; // the caller waits for every call to finish
+		std::atomic<std::size_t> next{0};
+		std::atomic<std::size_t> finished{0};
+		std::exception_ptr error; // guarded by mutex_
+		// the caller's api, and the stats of the calls workers made for it (guarded by mutex_)
+		const stats::api api{stats::detail::state.current};
+		stats::counters lent{};
+	};
+
+	thread_pool::thread_pool(std::size_t threads) {
+		for (std::size_t i = 1; i < threads; ++i) {
+			workers_.emplace_back([this] { work_(); });
+		}
+	}
+
+	thread_pool::~thread_pool() {
+		{
+			const auto lock_ = std::lock_guard{mutex_};
+			stopping_ = true;
+		}
+		work_cv_.notify_all();
+		for (auto &w : workers_) {
+			w.join();
+		}
+	}
+
+	auto thread_pool::size() const noexcept -> std::size_t {
+		return workers_.size() + 1;
+	}
+
+	auto thread_pool::for_each_index(std::size_t n, const std::function<void(std::size_t)> &f) -> void {
+		if (n == 0) {
+			return;
+		}
+		const auto job_ = std::make_shared<job>(n, f);
+		if (!workers_.empty() && n > 1) {
+			{
+				const auto lock_ = std::lock_guard{mutex_};
+				jobs_.push_back(job_);
+			}
+			work_cv_.notify_all();
+		}
+		run_(*job_, false);
+
+		auto lock_ = std::unique_lock{mutex_};
+		done_cv_.wait(lock_, [&] { return job_->finished == n; });
+		if constexpr (stats::enabled) {
+			stats::detail::add_to_current(job_->lent);
+		}
+		// workers drop a job when they find it exhausted, but one may not have looked yet
+		std::erase(jobs_, job_);
+		if (job_->error) {
+			std::rethrow_exception(job_->error);
+		}
+	}
+
+	auto thread_pool::shared() -> thread_pool & {
+		static auto pool_ = thread_pool{std::max(1U, std::thread::hardware_concurrency())};
+		return pool_;
+	}
+
+	auto thread_pool::work_() -> void {
+		auto lock_ = std::unique_lock{mutex_};
+		while (true) {
+			work_cv_.wait(lock_, [this] { return stopping_ || !jobs_.empty(); });
+			if (jobs_.empty()) {
+				return;
+			}
+			// holding a reference keeps the job alive even once its caller has returned
+			const auto job_ = jobs_.front();
+			lock_.unlock();
+			run_(*job_, true);
+			lock_.lock();
+			if (!jobs_.empty() && jobs_.front() == job_) {
+				jobs_.pop_front();
+			}
+		}
+	}
+
+	// takes indices of j until there are none left; lent when running on a worker
+	auto thread_pool::run_(job &j, bool lent) -> void {
+		auto stats_ = std::optional<stats::detail::lent_scope>{};
+		if (stats::enabled && lent) {
+			stats_.emplace(j.api);
+		}
+		for (auto i = j.next++; i < j.n; i = j.next++) {
+			try {
+				j.f(i);
+			}
+			catch (...) {
+				const auto lock_ = std::lock_guard{mutex_};
+				if (!j.error) {
+					j.error = std::current_exception();
+				}
+			}
+			if (stats_) {
+				// handed over before the call counts as finished, so the caller cannot miss it
+				const auto taken_ = stats_->take();
+				const auto lock_ = std::lock_guard{mutex_};
+				j.lent.predicate_calls += taken_.predicate_calls;
+				j.lent.bytes_scanned += taken_.bytes_scanned;
+				j.lent.allocations += taken_.allocations;
+			}
+			if (++j.finished == j.n) {
+				// lock so that the caller cannot miss the notification between its check and its wait
+				const auto lock_ = std::lock_guard{mutex_};
+				done_cv_.notify_all();
+			}
+		}
+	}
+
+	auto size(const filtered_string_view &fsv, thread_pool &pool) -> std::size_t {
+		FSV_STATS_SCOPE(size);
+		const auto size_ = chunk_size(fsv.raw_size(), pool);
+		if (size_ == fsv.raw_size()) {
+			return fsv.size();
+		}
+		const auto counts_ = count_chunks(fsv, size_, pool);
+		return std::accumulate(counts_.begin(), counts_.end(), std::size_t{0});
+	}
+
+	auto to_string(const filtered_string_view &fsv, thread_pool &pool) -> std::string {
+		FSV_STATS_SCOPE(to_string);
+		const auto size_ = chunk_size(fsv.raw_size(), pool);
+		if (size_ == fsv.raw_size()) {
+			return static_cast<std::string>(fsv);
+		}
+		auto offsets_ = count_chunks(fsv, size_, pool);
+		const auto total_ = std::accumulate(offsets_.begin(), offsets_.end(), std::size_t{0});
+		std::exclusive_scan(offsets_.begin(), offsets_.end(), offsets_.begin(), std::size_t{0});
+
+		auto res_ = std::string{};
+		stats::note_allocation();
+		res_.resize(total_ + detail::compact_slack);
+		const auto *table_ = fsv.predicate().table();
+		pool.for_each_index(offsets_.size(), [&](std::size_t i) {
+			const auto piece_ = chunk(fsv, size_, i);
+			auto *out_ = res_.data() + offsets_[i];
+			if (table_ == nullptr) {
+				for (auto c : std::string_view{piece_.data(), piece_.raw_size()}) {
+					if (fsv.predicate()(c)) {
+						*out_++ = c;
+					}
+				}
+				return;
+			}
+			const auto *out_end_ = i + 1 < offsets_.size() ? res_.data() + offsets_[i + 1] : res_.data() + res_.size();
+			compact_chunk(piece_.data(), piece_.raw_size(), *table_, out_, out_end_);
+		});
+		res_.resize(total_);
+		return res_;
+	}
+
+	auto split(const filtered_string_view &fsv, const filtered_string_view &tok, thread_pool &pool)
+	    -> std::vector<filtered_string_view> {
+		FSV_STATS_SCOPE(split);
+		const auto size_ = chunk_size(fsv.raw_size(), pool);
+		const auto delim_ = static_cast<std::string>(tok);
+		if (size_ == fsv.raw_size() || delim_.empty() || par::size(fsv, pool) < delim_.size()) {
+			return fsv::split(fsv, tok);
+		}
+		const auto n_ = chunk_count(fsv.raw_size(), size_);
+		const auto fail_ = detail::kmp_failure(delim_);
+		auto chunks_ = std::vector<chunk_matches>(n_);
+		detail::visit_predicate<char>(fsv.predicate(), [&](const auto &pred) {
+			pool.for_each_index(n_, [&](std::size_t i) {
+				chunks_[i] = find_matches(fsv, delim_, fail_, i * size_, std::min(fsv.raw_size(), (i + 1) * size_), pred);
+			});
+		});
+
+		// Pick split()'s matches chunk by chunk. Once a match the chunk picked itself is picked
+		// again, the rest of the chunk's picks stand, as split() goes on from there the same way.
+		auto entry_ = std::vector<std::size_t>(n_);  // past the last match picked before each chunk
+		auto index_ = std::vector<std::size_t>(n_ + 1); // tokens ended by matches before each chunk
+		std::size_t end_ = 0;
+		for (std::size_t c = 0; c < n_; ++c) {
+			auto &chunk_ = chunks_[c];
+			entry_[c] = end_;
+			auto picked_ = std::size_t{0};
+			auto own_before_ = std::size_t{0};
+			auto agreed_ = false;
+			for (auto &m : chunk_.matches) {
+				if (m.picked && m.first >= end_) {
+					agreed_ = true;
+					break;
+				}
+				own_before_ += m.picked;
+				m.picked = m.first >= end_;
+				if (m.picked) {
+					end_ = m.last;
+					++picked_;
+				}
+			}
+			if (agreed_) {
+				picked_ += chunk_.picked - own_before_;
+				end_ = chunk_.end;
+			}
+			index_[c + 1] = index_[c] + picked_;
+		}
+
+		auto res_ = std::vector<filtered_string_view>(index_[n_] + 1);
+		stats::note_allocation();
+		detail::visit_predicate<char>(fsv.predicate(), [&](const auto &pred) {
+			const auto *ptr_ = fsv.data();
+			// the token over raw [first, last), trimmed to its kept chars like split() does
+			auto token_ = [&](std::size_t first, std::size_t last) {
+				while (first < last && !pred(ptr_[first])) {
+					++first;
+				}
+				while (last > first && !pred(ptr_[last - 1])) {
+					--last;
+				}
+				return first == last ? filtered_string_view{ptr_, 0, fsv.predicate()}
+				                     : filtered_string_view{ptr_ + first, last - first, fsv.predicate()};
+			};
+			pool.for_each_index(n_, [&](std::size_t c) {
+				auto prev_ = entry_[c];
+				auto out_ = index_[c];
+				for (const auto &m : chunks_[c].matches) {
+					if (m.picked) {
+						res_[out_++] = token_(prev_, m.first);
+						prev_ = m.last;
+					}
+				}
+			});
+			res_.back() = token_(end_, fsv.raw_size());
+		});
+		return res_;
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef COMP6771_ASS2_PARALLEL_H
+#define COMP6771_ASS2_PARALLEL_H
+
+#include "./filtered_string_view.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Multi-threaded versions of the view operations that scan the whole buffer, for views over
+// many megabytes. The raw data is cut into chunks that are worked on by the threads of a
+// thread_pool; views smaller than a couple of chunks are handled on the calling thread.
+// The predicate is called from several threads at once and must allow it. With stats enabled,
+// the work done on the pool's threads is counted under the call on the calling thread.
+namespace fsv::par {
+	// A fixed set of worker threads. Calls from any number of threads may share one pool.
+	class thread_pool {
+	 public:
+		// threads counts the calling thread, so a pool of 1 runs everything on the caller
+		explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency());
+		thread_pool(const thread_pool &) = delete;
+		auto operator=(const thread_pool &) -> thread_pool & = delete;
+		~thread_pool();
+
+		// number of threads that work on a call, the caller included
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		// Calls f(i) once for every i in [0, n), spread over the workers and the calling thread,
+		// and returns when all calls have. If any call throws, the first exception is rethrown
+		// once the others are done.
+		auto for_each_index(std::size_t n, const std::function<void(std::size_t)> &f) -> void;
+
+		// the pool the functions below use by default, with one thread per core
+		[[nodiscard]] static auto shared() -> thread_pool &;
+
+	 private:
+		struct job;
+
+		auto work_() -> void;
+		auto run_(job &j, bool lent) -> void;
+
+		std::vector<std::thread> workers_;
+		std::deque<std::shared_ptr<job>> jobs_; // calls with indices left to hand out
+		std::mutex mutex_;
+		std::condition_variable work_cv_;
+		std::condition_variable done_cv_;
+		bool stopping_{false};
+	};
+
+	// fsv.size(), counting the chunks in parallel
+	[[nodiscard]] auto size(const filtered_string_view &fsv, thread_pool &pool = thread_pool::shared()) -> std::size_t;
+	// static_cast<std::string>(fsv): each chunk is counted, and, from the prefix sums of the
+	// counts, compacted straight into its place in the result
+	[[nodiscard]] auto to_string(const filtered_string_view &fsv, thread_pool &pool = thread_pool::shared()) -> std::string;
+	// split(fsv, tok), with the same tokens in the same order. Each chunk collects the delimiter
+	// matches that start in it, overlapping ones included, reading on into the next chunk for
+	// those that straddle the boundary. A sequential pass then picks the leftmost non-overlapping
+	// matches, as split() does, stopping early in each chunk once its picks agree with the
+	// chunk's own. Every chunk writes its tokens straight into their place in the result.
+	[[nodiscard]] auto split(const filtered_string_view &fsv, const filtered_string_view &tok,
+	                         thread_pool &pool = thread_pool::shared()) -> std::vector<filtered_string_view>;
+}
+
+#endif // COMP6771_ASS2_PARALLEL_H
@@ -0,0 +1,133 @@
+#include "./parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("thread_pool") {
+	auto pool = fsv::par::thread_pool{4};
+	REQUIRE(pool.size() == 4);
+
+	SECTION("calls f once per index") {
+		auto seen = std::vector<std::atomic<int>>(1000);
+		pool.for_each_index(seen.size(), [&](std::size_t i) { ++seen[i]; });
+		for (const auto &s : seen) {
+			REQUIRE(s == 1);
+		}
+		pool.for_each_index(0, [](std::size_t) { throw std::logic_error{"no indices"}; });
+	}
+
+	SECTION("rethrows the first exception once every call is done") {
+		auto calls = std::atomic<int>{0};
+		REQUIRE_THROWS_AS(pool.for_each_index(100, [&](std::size_t i) {
+			++calls;
+			if (i % 10 == 3) {
+				throw std::runtime_error{"chunk failed"};
+			}
+		}), std::runtime_error);
+		REQUIRE(calls == 100);
+	}
+
+	SECTION("is shared by concurrent callers, including nested ones") {
+		auto total = std::atomic<std::size_t>{0};
+		auto callers = std::vector<std::thread>{};
+		for (auto t = 0; t < 3; ++t) {
+			callers.emplace_back([&] {
+				pool.for_each_index(20, [&](std::size_t) {
+					pool.for_each_index(10, [&](std::size_t j) { total += j; });
+				});
+			});
+		}
+		for (auto &c : callers) {
+			c.join();
+		}
+		REQUIRE(total == 3 * 20 * 45);
+	}
+
+	SECTION("a pool of one runs everything on the caller") {
+		auto single = fsv::par::thread_pool{1};
+		const auto caller = std::this_thread::get_id();
+		auto elsewhere = false;
+		single.for_each_index(50, [&](std::size_t) { elsewhere = elsewhere || std::this_thread::get_id() != caller; });
+		REQUIRE_FALSE(elsewhere);
+	}
+}
+
+TEST_CASE("parallel size and to_string") {
+	auto gen = std::mt19937{24};
+	// big enough to be cut into chunks, with a ragged last chunk
+	auto input = std::string((std::size_t{3} << 20) + 12345, ' ');
+	for (auto &c : input) {
+		c = static_cast<char>(gen() % 128);
+	}
+	auto pool = fsv::par::thread_pool{4};
+	const auto odd = [](const char &c) { return c % 2 == 1; };
+	const auto filters = std::vector<fsv::filter>{{}, odd, fsv::char_table{odd}, fsv::char_table{[](const char &c) { return c == 'x'; }}};
+
+	for (const auto &pred : filters) {
+		for (auto len : {std::size_t{0}, std::size_t{1000}, input.size()}) {
+			const auto view = fsv::filtered_string_view{input.data(), len, pred};
+			const auto expected = static_cast<std::string>(view);
+			REQUIRE(fsv::par::size(view, pool) == view.size());
+			REQUIRE(fsv::par::to_string(view, pool) == expected);
+			REQUIRE(fsv::par::to_string(view) == expected);
+		}
+	}
+	REQUIRE(fsv::par::to_string(fsv::filtered_string_view{}).empty());
+}
+
+TEST_CASE("parallel split") {
+	auto pool = fsv::par::thread_pool{4};
+	const auto not_dash = [](const char &c) { return c != '-'; };
+	const auto filters = std::vector<fsv::filter>{{}, not_dash, fsv::char_table{not_dash}};
+
+	// the tokens must be the very views split() cuts, not just equal to them
+	auto same_as_split = [&](const fsv::filtered_string_view &view, const std::string &delim) {
+		const auto expected = fsv::split(view, delim);
+		const auto tokens = fsv::par::split(view, delim, pool);
+		REQUIRE(std::equal(tokens.begin(), tokens.end(), expected.begin(), expected.end(), [](const auto &a, const auto &b) {
+			return a.data() == b.data() && a.raw_size() == b.raw_size();
+		}));
+	};
+
+	SECTION("agrees with split across random inputs") {
+		auto gen = std::mt19937{25};
+		auto input = std::string((std::size_t{640} << 10) + 777, ' ');
+		for (const auto *alphabet : {"ab-\n", "aab-"}) {
+			const auto n = std::char_traits<char>::length(alphabet);
+			for (auto &c : input) {
+				c = alphabet[gen() % n];
+			}
+			for (const auto &pred : filters) {
+				const auto view = fsv::filtered_string_view{input.data(), input.size(), pred};
+				// overlapping delimiters pick the leftmost matches whichever chunk they start in
+				for (const auto *delim : {"\n", "a", "aa", "aba", "b-a", ""}) {
+					same_as_split(view, delim);
+				}
+			}
+		}
+	}
+
+	SECTION("delimiters straddling chunk boundaries") {
+		// chunks are multiples of 64 bytes, so every power-of-two boundary is one of them
+		auto input = std::string(std::size_t{1} << 20, 'x');
+		for (std::size_t b = 1 << 12; b < input.size(); b += 1 << 12) {
+			input.replace(b - 2, 4, "<-->");
+		}
+		for (const auto &pred : filters) {
+			const auto view = fsv::filtered_string_view{input.data(), input.size(), pred};
+			same_as_split(view, "<>");
+			same_as_split(view, "<-->");
+			same_as_split(view, "x<");
+		}
+		// a run of matches that overlap all the way through the buffer
+		const auto as = std::string(std::size_t{1} << 20, 'a');
+		same_as_split(fsv::filtered_string_view{as}, "aa");
+		same_as_split(fsv::filtered_string_view{as}, "aaa");
+	}
+}
@@ -0,0 +1,141 @@
+#include "./perf_counters.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fsv::bench {
+	auto counter_name(counter c) noexcept -> std::string_view {
+		switch (c) {
+		case counter::cycles: return "cycles";
+		case counter::instructions: return "instructions";
+		case counter::branch_misses: return "branch_misses";
+		case counter::l1d_misses: return "l1d_misses";
+		case counter::llc_misses: return "llc_misses";
+		}
+		return "unknown";
+	}
+
+#ifdef __linux__
+	namespace {
+		auto make_attr(counter c) noexcept -> perf_event_attr {
+			perf_event_attr res_{};
+			res_.size = sizeof(res_);
+			res_.disabled = 1;
+			res_.exclude_kernel = 1;
+			res_.exclude_hv = 1;
+			// count threads started later too, e.g. the fsv::par pool's workers
+			res_.inherit = 1;
+			res_.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			const auto cache_miss_ = [](std::uint64_t cache) {
+				return cache | (std::uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8)
+				       | (std::uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16);
+			};
+			switch (c) {
+			case counter::cycles:
+				res_.type = PERF_TYPE_HARDWARE;
+				res_.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case counter::instructions:
+				res_.type = PERF_TYPE_HARDWARE;
+				res_.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case counter::branch_misses:
+				res_.type = PERF_TYPE_HARDWARE;
+				res_.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			case counter::l1d_misses:
+				res_.type = PERF_TYPE_HW_CACHE;
+				res_.config = cache_miss_(PERF_COUNT_HW_CACHE_L1D);
+				break;
+			case counter::llc_misses:
+				res_.type = PERF_TYPE_HW_CACHE;
+				res_.config = cache_miss_(PERF_COUNT_HW_CACHE_LL);
+				break;
+			}
+			return res_;
+		}
+	}
+
+	perf_counters::perf_counters() {
+		for (std::size_t i = 0; i < counter_count; ++i) {
+			const auto c_ = static_cast<counter>(i);
+			auto attr_ = make_attr(c_);
+			fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr_, 0, -1, -1, 0));
+			if (fds_[i] < 0) {
+				error_ += (error_.empty() ? "" : "; ") + std::string{counter_name(c_)} + ": " + std::strerror(errno);
+			}
+		}
+	}
+
+	perf_counters::~perf_counters() {
+		for (auto fd : fds_) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+	auto perf_counters::start() noexcept -> void {
+		for (auto fd : fds_) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+	}
+
+	auto perf_counters::stop() noexcept -> void {
+		for (auto fd : fds_) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			}
+		}
+	}
+
+	auto perf_counters::read() const noexcept -> values {
+		values res_{};
+		for (std::size_t i = 0; i < counter_count; ++i) {
+			// value, time enabled, time running
+			std::uint64_t buf_[3] = {};
+			if (fds_[i] < 0 || ::read(fds_[i], buf_, sizeof(buf_)) != static_cast<ssize_t>(sizeof(buf_)) || buf_[2] == 0) {
+				continue;
+			}
+			res_[i] = static_cast<double>(buf_[0]) * static_cast<double>(buf_[1]) / static_cast<double>(buf_[2]);
+		}
+		return res_;
+	}
+#else
+	perf_counters::perf_counters() : error_{"perf_event_open is only available on Linux"} {
+		fds_.fill(-1);
+	}
+
+	perf_counters::~perf_counters() = default;
+
+	auto perf_counters::start() noexcept -> void {}
+
+	auto perf_counters::stop() noexcept -> void {}
+
+	auto perf_counters::read() const noexcept -> values {
+		return values{};
+	}
+#endif
+
+	auto perf_counters::available() const noexcept -> bool {
+		for (auto fd : fds_) {
+			if (fd >= 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	auto perf_counters::error() const -> const std::string & {
+		return error_;
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef COMP6771_ASS2_PERF_COUNTERS_H
+#define COMP6771_ASS2_PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Hardware performance counters for the benchmarks, read through Linux perf_event_open.
+// Each counter is opened on its own, for user space only, so that one the kernel or CPU
+// refuses does not take the others with it. Counts cover this thread and any thread it starts
+// after the counters are opened (not threads that already exist), so a thread pool must be
+// created after them for its work to be counted. When none can be opened (other
+// platforms, perf_event_paranoid, VMs without a PMU) the collector is simply unavailable.
+namespace fsv::bench {
+	enum class counter { cycles, instructions, branch_misses, l1d_misses, llc_misses };
+
+	inline constexpr std::size_t counter_count = 5;
+
+	[[nodiscard]] auto counter_name(counter c) noexcept -> std::string_view;
+
+	class perf_counters {
+	 public:
+		using values = std::array<std::optional<double>, counter_count>;
+
+		perf_counters();
+		perf_counters(const perf_counters &) = delete;
+		auto operator=(const perf_counters &) -> perf_counters & = delete;
+		~perf_counters();
+
+		// whether at least one counter could be opened
+		[[nodiscard]] auto available() const noexcept -> bool;
+		// why counters are missing, e.g. "cycles: Permission denied"; empty if all opened
+		[[nodiscard]] auto error() const -> const std::string &;
+
+		// resets and starts every open counter
+		auto start() noexcept -> void;
+		auto stop() noexcept -> void;
+		// counts since the last start(), scaled up if the kernel had to multiplex counters;
+		// nullopt for counters that are not open
+		[[nodiscard]] auto read() const noexcept -> values;
+
+	 private:
+		std::array<int, counter_count> fds_;
+		std::string error_;
+	};
+}
+
+#endif // COMP6771_ASS2_PERF_COUNTERS_H
@@ -0,0 +1,94 @@
+#ifndef COMP6771_ASS2_PRED_H
+#define COMP6771_ASS2_PRED_H
+
+#include "./char_table.h"
+
+#include <concepts>
+#include <string_view>
+#include <type_traits>
+
+// Predicate combinators for char views.
+// Everything here is constexpr and yields a char_table, so any combination of them is
+// still a single 256-bit lookup and keeps the kernel fast path once handed to a view:
+//   fsv::filtered_string_view{s, fsv::pred::not_(fsv::pred::any_of(" \t"))}
+namespace fsv::pred {
+	// keeps every char
+	inline constexpr char_table all = ~char_table{};
+	// keeps nothing
+	inline constexpr char_table none = char_table{};
+
+	// keeps the chars in chars
+	[[nodiscard]] constexpr auto any_of(std::string_view chars) noexcept -> char_table {
+		auto res_ = char_table{};
+		for (auto c : chars) {
+			res_.set(c);
+		}
+		return res_;
+	}
+
+	// keeps the chars not in chars
+	[[nodiscard]] constexpr auto none_of(std::string_view chars) noexcept -> char_table {
+		return ~any_of(chars);
+	}
+
+	[[nodiscard]] constexpr auto is(char c) noexcept -> char_table {
+		return char_table{}.set(c);
+	}
+
+	// keeps the chars whose byte value lies in [lo, hi]
+	[[nodiscard]] constexpr auto range(char lo, char hi) noexcept -> char_table {
+		auto res_ = char_table{};
+		for (auto u = static_cast<unsigned>(static_cast<unsigned char>(lo)); u <= static_cast<unsigned char>(hi); ++u) {
+			res_.set(static_cast<char>(static_cast<unsigned char>(u)));
+		}
+		return res_;
+	}
+
+	// ASCII character classes
+	inline constexpr char_table digit = range('0', '9');
+	inline constexpr char_table lower = range('a', 'z');
+	inline constexpr char_table upper = range('A', 'Z');
+	inline constexpr char_table alpha = lower | upper;
+	inline constexpr char_table alnum = alpha | digit;
+	inline constexpr char_table xdigit = digit | range('a', 'f') | range('A', 'F');
+	inline constexpr char_table space = any_of(" \t\n\v\f\r");
+	inline constexpr char_table punct = range('!', '/') | range(':', '@') | range('[', '`') | range('{', '~');
+	inline constexpr char_table cntrl = range('\0', '\x1f') | is('\x7f');
+	inline constexpr char_table print = range(' ', '~');
+
+	namespace detail {
+		// Combinator arguments may be tables or any pure char predicate, which is tabulated.
+		template<typename P>
+		requires std::predicate<const P &, const char &>
+		constexpr auto as_table(const P &p) -> char_table {
+			if constexpr (std::is_same_v<P, char_table>) {
+				return p;
+			}
+			else {
+				return char_table{p};
+			}
+		}
+	}
+
+	template<typename P>
+	[[nodiscard]] constexpr auto not_(const P &p) -> char_table {
+		return ~detail::as_table(p);
+	}
+
+	template<typename P, typename... Ps>
+	[[nodiscard]] constexpr auto and_(const P &p, const Ps &...ps) -> char_table {
+		return (detail::as_table(p) & ... & detail::as_table(ps));
+	}
+
+	template<typename P, typename... Ps>
+	[[nodiscard]] constexpr auto or_(const P &p, const Ps &...ps) -> char_table {
+		return (detail::as_table(p) | ... | detail::as_table(ps));
+	}
+
+	template<typename P, typename... Ps>
+	[[nodiscard]] constexpr auto xor_(const P &p, const Ps &...ps) -> char_table {
+		return (detail::as_table(p) ^ ... ^ detail::as_table(ps));
+	}
+}
+
+#endif // COMP6771_ASS2_PRED_H
@@ -0,0 +1,233 @@
+#include "./rank_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace fsv {
+	namespace {
+		// position of the r-th set bit (0-based) of word; word must have more than r set bits
+		auto select_in_word(std::uint64_t word, std::size_t r) noexcept -> std::size_t {
+			std::size_t base_ = 0;
+			for (;;) {
+				auto byte_ = static_cast<std::size_t>(std::popcount(word & 0xffu));
+				if (r < byte_) {
+					break;
+				}
+				r -= byte_;
+				word >>= 8;
+				base_ += 8;
+			}
+			for (; r > 0; --r) {
+				word &= word - 1;
+			}
+			return base_ + static_cast<std::size_t>(std::countr_zero(word));
+		}
+	}
+
+	auto rank_index::classify_(const char_table &table) noexcept -> void {
+		const auto &bits_ = table.words();
+		for (std::size_t w = 0; w < words_.size(); ++w) {
+			const auto *p_ = ptr_ + w * word_bits;
+			const auto n_ = std::min(word_bits, len_ - w * word_bits);
+			std::uint64_t word_ = 0;
+			for (std::size_t i = 0; i < n_; ++i) {
+				const auto u_ = static_cast<unsigned char>(p_[i]);
+				word_ |= ((bits_[u_ >> 6] >> (u_ & 63u)) & 1u) << i;
+			}
+			words_[w] = word_;
+		}
+	}
+
+	auto rank_index::finish_() -> void {
+		const auto n_blocks_ = (words_.size() + block_words - 1) / block_words;
+		blocks_.reserve(n_blocks_ + 1);
+		for (std::size_t w = 0; w < words_.size(); ++w) {
+			if (w % block_words == 0) {
+				blocks_.push_back(count_);
+			}
+			count_ += static_cast<std::size_t>(std::popcount(words_[w]));
+		}
+		blocks_.push_back(count_);
+
+		// samples_[k] is the block holding kept char k * sample_rate
+		samples_.reserve(count_ / sample_rate + 1);
+		for (std::size_t b = 0; b < n_blocks_; ++b) {
+			while (samples_.size() * sample_rate < blocks_[b + 1]) {
+				samples_.push_back(b);
+			}
+		}
+	}
+
+	auto rank_index::size() const noexcept -> std::size_t {
+		return count_;
+	}
+
+	auto rank_index::empty() const noexcept -> bool {
+		return count_ == 0;
+	}
+
+	auto rank_index::data() const noexcept -> const char * {
+		return ptr_;
+	}
+
+	auto rank_index::raw_size() const noexcept -> std::size_t {
+		return len_;
+	}
+
+	auto rank_index::select(std::size_t n) const noexcept -> std::size_t {
+		// The block holding kept char n lies between the samples either side of it; a sparse
+		// filter can leave any number of blocks between two samples, so binary search them.
+		const auto k_ = n / sample_rate;
+		const auto first_ = blocks_.begin() + static_cast<std::ptrdiff_t>(samples_[k_]) + 1;
+		const auto last_ = k_ + 1 < samples_.size() ? blocks_.begin() + static_cast<std::ptrdiff_t>(samples_[k_ + 1]) + 1
+		                                             : blocks_.end();
+		const auto b = static_cast<std::size_t>(std::upper_bound(first_, last_, n) - blocks_.begin()) - 1;
+		auto r = n - blocks_[b];
+		for (auto w = b * block_words;; ++w) {
+			auto pop_ = static_cast<std::size_t>(std::popcount(words_[w]));
+			if (r < pop_) {
+				return w * word_bits + select_in_word(words_[w], r);
+			}
+			r -= pop_;
+		}
+	}
+
+	auto rank_index::rank(std::size_t pos) const noexcept -> std::size_t {
+		if (pos >= len_) {
+			return count_;
+		}
+		const auto w_ = pos / word_bits;
+		auto res_ = blocks_[w_ / block_words];
+		for (auto w = w_ - w_ % block_words; w < w_; ++w) {
+			res_ += static_cast<std::size_t>(std::popcount(words_[w]));
+		}
+		const auto mask_ = (std::uint64_t{1} << (pos % word_bits)) - 1;
+		return res_ + static_cast<std::size_t>(std::popcount(words_[w_] & mask_));
+	}
+
+	auto rank_index::test(std::size_t pos) const noexcept -> bool {
+		return pos < len_ && ((words_[pos / word_bits] >> (pos % word_bits)) & 1u) != 0;
+	}
+
+	auto rank_index::next(std::size_t pos) const noexcept -> std::size_t {
+		if (pos >= len_) {
+			return len_;
+		}
+		auto w = pos / word_bits;
+		auto word_ = words_[w] & (~std::uint64_t{0} << (pos % word_bits));
+		while (word_ == 0) {
+			if (++w == words_.size()) {
+				return len_;
+			}
+			word_ = words_[w];
+		}
+		return w * word_bits + static_cast<std::size_t>(std::countr_zero(word_));
+	}
+
+	auto rank_index::prev(std::size_t pos) const noexcept -> std::size_t {
+		auto w = (pos - 1) / word_bits;
+		auto shift_ = word_bits - 1 - (pos - 1) % word_bits;
+		auto word_ = words_[w] << shift_ >> shift_;
+		while (word_ == 0) {
+			word_ = words_[--w];
+		}
+		return w * word_bits + word_bits - 1 - static_cast<std::size_t>(std::countl_zero(word_));
+	}
+
+	auto rank_index::covers_(const char *ptr, std::size_t len) const noexcept -> bool {
+		if (ptr == nullptr || len == 0) {
+			return true;
+		}
+		return ptr_ != nullptr && std::less_equal<>{}(ptr_, ptr) && std::less_equal<>{}(ptr + len, ptr_ + len_);
+	}
+
+	auto rank_index::span_(const char *ptr, std::size_t len) const -> std::pair<std::size_t, std::size_t> {
+		if (!covers_(ptr, len)) {
+			throw std::domain_error{"rank_index: view is not covered by the index"};
+		}
+		if (ptr == nullptr || len == 0) {
+			return {0, 0};
+		}
+		const auto first_ = static_cast<std::size_t>(ptr - ptr_);
+		return {first_, first_ + len};
+	}
+
+	auto rank_index::begin() const noexcept -> const_iterator {
+		return iter{this, next(0)};
+	}
+
+	auto rank_index::end() const noexcept -> const_iterator {
+		return iter{this, len_};
+	}
+
+	rank_index::iter::iter(const rank_index *idx, std::size_t pos) noexcept : idx_{idx}, pos_{pos} {}
+
+	auto rank_index::iter::operator*() const -> reference {
+		return idx_->ptr_[pos_];
+	}
+
+	auto rank_index::iter::operator->() const -> pointer {
+		return idx_->ptr_ + pos_;
+	}
+
+	auto rank_index::iter::operator[](difference_type n) const -> reference {
+		return *(*this + n);
+	}
+
+	auto rank_index::iter::operator++() -> iter & {
+		pos_ = idx_->next(pos_ + 1);
+		return *this;
+	}
+
+	auto rank_index::iter::operator++(int) -> iter {
+		iter temp (*this);
+		++*this;
+		return temp;
+	}
+
+	auto rank_index::iter::operator--() -> iter & {
+		pos_ = idx_->prev(pos_);
+		return *this;
+	}
+
+	auto rank_index::iter::operator--(int) -> iter {
+		iter temp (*this);
+		--*this;
+		return temp;
+	}
+
+	auto rank_index::iter::operator+=(difference_type n) -> iter & {
+		auto r = static_cast<difference_type>(idx_->rank(pos_)) + n;
+		pos_ = static_cast<std::size_t>(r) >= idx_->count_ ? idx_->len_ : idx_->select(static_cast<std::size_t>(r));
+		return *this;
+	}
+
+	auto rank_index::iter::operator-=(difference_type n) -> iter & {
+		return *this += -n;
+	}
+
+	auto operator+(rank_index::const_iterator it, std::ptrdiff_t n) -> rank_index::const_iterator {
+		return it += n;
+	}
+
+	auto operator+(std::ptrdiff_t n, rank_index::const_iterator it) -> rank_index::const_iterator {
+		return it += n;
+	}
+
+	auto operator-(rank_index::const_iterator it, std::ptrdiff_t n) -> rank_index::const_iterator {
+		return it -= n;
+	}
+
+	auto operator-(const rank_index::const_iterator &lhs, const rank_index::const_iterator &rhs) -> std::ptrdiff_t {
+		return static_cast<std::ptrdiff_t>(lhs.idx_->rank(lhs.pos_)) - static_cast<std::ptrdiff_t>(rhs.idx_->rank(rhs.pos_));
+	}
+
+	auto operator==(const rank_index::const_iterator &lhs, const rank_index::const_iterator &rhs) -> bool {
+		return lhs.pos_ == rhs.pos_;
+	}
+
+	auto operator<=>(const rank_index::const_iterator &lhs, const rank_index::const_iterator &rhs) -> std::strong_ordering {
+		return lhs.pos_ <=> rhs.pos_;
+	}
+}
@@ -0,0 +1,211 @@
+#ifndef COMP6771_ASS2_RANK_INDEX_H
+#define COMP6771_ASS2_RANK_INDEX_H
+
+#include "./filtered_string_view.h"
+
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace fsv {
+	// Rank/select sidecar for a (buffer, predicate) pair.
+	// Built once with one predicate call per byte (a table lookup for char_table-backed
+	// predicates); afterwards filtered index -> raw offset
+	// lookups are answered from a popcounted bitmap without calling the predicate again.
+	// The index does not own the buffer, and views over any sub-range of the indexed
+	// buffer (e.g. results of substr or split) can be answered by the same index, as long as
+	// they filter with the same predicate. That is checked as far as it can be: table-backed
+	// predicates must keep the same bytes, filters must share the index's filter (be copies of
+	// it), and other predicates must be of the same type.
+	class rank_index {
+		class iter {
+		 public:
+			using difference_type = std::ptrdiff_t;
+			using value_type = char;
+			using pointer = const char *;
+			using reference = const char &;
+			using iterator_category = std::random_access_iterator_tag;
+
+			iter() = default;
+			iter(const rank_index *idx, std::size_t pos) noexcept;
+
+			auto operator*() const -> reference;
+			auto operator->() const -> pointer;
+			auto operator[](difference_type n) const -> reference;
+
+			auto operator++() -> iter&;
+			auto operator++(int) -> iter;
+			auto operator--() -> iter&;
+			auto operator--(int) -> iter;
+			auto operator+=(difference_type n) -> iter&;
+			auto operator-=(difference_type n) -> iter&;
+
+			friend auto operator+(iter it, difference_type n) -> iter;
+			friend auto operator+(difference_type n, iter it) -> iter;
+			friend auto operator-(iter it, difference_type n) -> iter;
+			friend auto operator-(const iter &lhs, const iter &rhs) -> difference_type;
+			friend auto operator==(const iter &lhs, const iter &rhs) -> bool;
+			friend auto operator<=>(const iter &lhs, const iter &rhs) -> std::strong_ordering;
+
+		 private:
+			const rank_index *idx_{nullptr};
+			std::size_t pos_{0}; // raw offset of the current kept char, or raw_size() at the end
+		};
+
+	 public:
+		using iterator = iter;
+		using const_iterator = iter;
+
+		rank_index() noexcept = default;
+		template<typename Pred>
+		explicit rank_index(const basic_filtered_string_view<char, Pred> &fsv);
+
+		// number of kept chars in the indexed buffer
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+		[[nodiscard]] auto empty() const noexcept -> bool;
+		[[nodiscard]] auto data() const noexcept -> const char *;
+		[[nodiscard]] auto raw_size() const noexcept -> std::size_t;
+
+		// raw offset of the n-th kept char; n must be less than size()
+		[[nodiscard]] auto select(std::size_t n) const noexcept -> std::size_t;
+		// number of kept chars in the raw range [0, pos)
+		[[nodiscard]] auto rank(std::size_t pos) const noexcept -> std::size_t;
+		// whether the char at raw offset pos is kept
+		[[nodiscard]] auto test(std::size_t pos) const noexcept -> bool;
+		// raw offset of the first kept char at or after pos, or raw_size() if there is none
+		[[nodiscard]] auto next(std::size_t pos) const noexcept -> std::size_t;
+		// raw offset of the last kept char before pos; there must be one
+		[[nodiscard]] auto prev(std::size_t pos) const noexcept -> std::size_t;
+		// whether fsv views a sub-range of the indexed buffer
+		template<typename Pred>
+		[[nodiscard]] auto covers(const basic_filtered_string_view<char, Pred> &fsv) const noexcept -> bool {
+			return covers_(fsv.data(), fsv.raw_size());
+		}
+		// raw offsets [first, last) of fsv's buffer relative to data()
+		// Throws: std::domain_error if fsv is not covered by this index, or does not filter with
+		// the predicate the index was built with.
+		template<typename Pred>
+		[[nodiscard]] auto span(const basic_filtered_string_view<char, Pred> &fsv) const -> std::pair<std::size_t, std::size_t> {
+			const auto res_ = span_(fsv.data(), fsv.raw_size());
+			if (res_.first != res_.second && !built_with_(fsv.predicate())) {
+				throw std::domain_error{"rank_index: view does not use the index's predicate"};
+			}
+			return res_;
+		}
+
+		[[nodiscard]] auto begin() const noexcept -> const_iterator;
+		[[nodiscard]] auto end() const noexcept -> const_iterator;
+
+	 private:
+		// fills in words_ by looking every byte up in table, without calling a predicate
+		auto classify_(const char_table &table) noexcept -> void;
+		// computes the counts, block ranks and select samples once words_ is filled in
+		auto finish_() -> void;
+		[[nodiscard]] auto covers_(const char *ptr, std::size_t len) const noexcept -> bool;
+		[[nodiscard]] auto span_(const char *ptr, std::size_t len) const -> std::pair<std::size_t, std::size_t>;
+		// whether pred is, as far as can be told, the predicate the index was built with
+		template<typename Pred>
+		[[nodiscard]] auto built_with_(const Pred &pred) const noexcept -> bool {
+			if (const auto *known_ = detail::table_of(pred)) {
+				return has_table_ && *known_ == table_;
+			}
+			if constexpr (std::is_same_v<Pred, filter>) {
+				return !has_table_ && pred.id() == pred_id_;
+			}
+			else {
+				return !has_table_ && pred_type_ != nullptr && *pred_type_ == typeid(Pred);
+			}
+		}
+
+		static constexpr std::size_t word_bits = 64;
+		static constexpr std::size_t block_words = 8;
+		static constexpr std::size_t sample_rate = 512; // kept chars between select samples
+
+		const char *ptr_{nullptr};
+		std::size_t len_{0};
+		std::size_t count_{0};
+		// the predicate the index was built with: its table if it has one, otherwise its type and,
+		// for a filter, its id()
+		char_table table_;
+		bool has_table_{false};
+		const std::type_info *pred_type_{nullptr};
+		const void *pred_id_{nullptr};
+		std::vector<std::uint64_t> words_; // bit i set iff the char at raw offset i is kept
+		std::vector<std::size_t> blocks_; // kept chars before each block, plus the total
+		std::vector<std::size_t> samples_; // block holding every sample_rate-th kept char
+	};
+
+	template<typename Pred>
+	rank_index::rank_index(const basic_filtered_string_view<char, Pred> &fsv)
+	: ptr_{fsv.data()}, len_{fsv.data() == nullptr ? 0 : fsv.raw_size()} {
+		words_.assign((len_ + word_bits - 1) / word_bits, 0);
+		const auto &pred_ = fsv.predicate();
+		if (const auto *known_ = detail::table_of(pred_)) {
+			table_ = *known_;
+			has_table_ = true;
+			classify_(table_);
+		}
+		else {
+			pred_type_ = &typeid(Pred);
+			if constexpr (std::is_same_v<Pred, filter>) {
+				pred_id_ = pred_.id();
+			}
+			for (std::size_t i = 0; i < len_; ++i) {
+				if (pred_(ptr_[i])) {
+					words_[i / word_bits] |= std::uint64_t{1} << (i % word_bits);
+				}
+			}
+		}
+		finish_();
+	}
+
+	// Same as fsv.at(n) / fsv::substr(fsv, pos, count), answered through idx.
+	// Throws: std::domain_error if idx was not built over the buffer fsv views, or the index is invalid.
+	template<typename Pred>
+	[[nodiscard]] auto at(const basic_filtered_string_view<char, Pred> &fsv, int n, const rank_index &idx) -> const char & {
+		const auto [first_, last_] = idx.span(fsv);
+		if (n < 0) {
+			detail::throw_invalid_index(n);
+		}
+		const auto k_ = idx.rank(first_) + static_cast<std::size_t>(n);
+		if (k_ >= idx.rank(last_)) {
+			detail::throw_invalid_index(n);
+		}
+		return idx.data()[idx.select(k_)];
+	}
+
+	template<typename Pred>
+	[[nodiscard]] auto substr(const basic_filtered_string_view<char, Pred> &fsv, int pos, int count, const rank_index &idx)
+	    -> basic_filtered_string_view<char, Pred> {
+		const auto [first_, last_] = idx.span(fsv);
+		const auto base_ = idx.rank(first_);
+		const auto size_ = static_cast<int>(idx.rank(last_) - base_);
+		auto rcount = count <= 0 ? size_ - pos : count;
+		if (pos < 0 || pos >= size_ || rcount < 0) {
+			std::string err_msg = "filtered_string_view::substr(" + std::to_string(pos) + ", " + std::to_string(count) + "): invalid index";
+			throw std::domain_error{err_msg.c_str()};
+		}
+		auto count_ = std::min(size_ - pos, rcount);
+		const auto begin_ = idx.select(base_ + static_cast<std::size_t>(pos));
+		const auto end_ = idx.select(base_ + static_cast<std::size_t>(pos + count_ - 1)) + 1;
+		return basic_filtered_string_view<char, Pred>{idx.data() + begin_, end_ - begin_, fsv.predicate()};
+	}
+
+	// The kept chars of fsv as a random access range driven by idx.
+	template<typename Pred>
+	[[nodiscard]] auto indexed(const basic_filtered_string_view<char, Pred> &fsv, const rank_index &idx)
+	    -> std::ranges::subrange<rank_index::const_iterator> {
+		const auto [first_, last_] = idx.span(fsv);
+		if (first_ == last_) {
+			return {idx.end(), idx.end()};
+		}
+		return {rank_index::const_iterator{&idx, idx.next(first_)}, rank_index::const_iterator{&idx, idx.next(last_)}};
+	}
+}
+
+#endif // COMP6771_ASS2_RANK_INDEX_H
@@ -0,0 +1,185 @@
+#include "./rank_index.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+	// a few thousand chars so that blocks, samples and multi-word scans are all exercised
+	auto make_text(std::size_t n) -> std::string {
+		auto s = std::string{};
+		for (std::size_t i = 0; i < n; ++i) {
+			s += static_cast<char>('a' + (i * 7 + i / 13) % 26);
+		}
+		return s;
+	}
+}
+
+TEST_CASE("rank_index construction") {
+	SECTION("empty view") {
+		auto idx = fsv::rank_index{fsv::filtered_string_view{}};
+		REQUIRE(idx.size() == 0);
+		REQUIRE(idx.empty());
+		REQUIRE(idx.begin() == idx.end());
+	}
+
+	SECTION("counts kept chars") {
+		auto s = make_text(5000);
+		auto is_vowel = [](const char &c) { return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u'; };
+		auto sv = fsv::filtered_string_view{s, is_vowel};
+		auto idx = fsv::rank_index{sv};
+		REQUIRE(idx.size() == sv.size());
+		REQUIRE(idx.raw_size() == s.size());
+		REQUIRE(idx.data() == s.data());
+	}
+
+	SECTION("table-backed predicates") {
+		auto s = make_text(5000) + "\xe9\x80";
+		auto is_vowel = [](const char &c) { return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c < 0; };
+		auto called = fsv::rank_index{fsv::filtered_string_view{s, is_vowel}};
+		for (const auto &pred : {fsv::filter{fsv::char_table{is_vowel}}, fsv::filter{is_vowel}}) {
+			auto idx = fsv::rank_index{fsv::filtered_string_view{s, pred}};
+			REQUIRE(idx.size() == called.size());
+			for (std::size_t i = 0; i < s.size(); ++i) {
+				REQUIRE(idx.test(i) == called.test(i));
+			}
+		}
+		auto idx = fsv::rank_index{fsv::basic_filtered_string_view<char, fsv::char_table>{s, fsv::char_table{is_vowel}}};
+		REQUIRE(idx.size() == called.size());
+		REQUIRE(idx.select(idx.size() - 1) == s.size() - 1);
+	}
+}
+
+TEST_CASE("rank_index rank and select") {
+	auto s = make_text(5000);
+	auto pred = [](const char &c) { return c < 'h'; };
+	auto sv = fsv::filtered_string_view{s, pred};
+	auto idx = fsv::rank_index{sv};
+
+	auto offsets = std::vector<std::size_t>{};
+	for (std::size_t i = 0; i < s.size(); ++i) {
+		REQUIRE(idx.rank(i) == offsets.size());
+		REQUIRE(idx.test(i) == pred(s[i]));
+		if (pred(s[i])) {
+			offsets.push_back(i);
+		}
+	}
+	REQUIRE(idx.rank(s.size()) == offsets.size());
+	for (std::size_t n = 0; n < offsets.size(); ++n) {
+		REQUIRE(idx.select(n) == offsets[n]);
+	}
+	REQUIRE(idx.next(0) == offsets.front());
+	REQUIRE(idx.prev(s.size()) == offsets.back());
+}
+
+TEST_CASE("rank_index select with a sparse predicate") {
+	// one kept char in about a thousand, so thousands of blocks lie between select samples,
+	// with a dense run in the middle so that some samples are close together
+	auto s = std::string(std::size_t{8} << 20, '.');
+	auto offsets = std::vector<std::size_t>{};
+	for (std::size_t i = 0; i < s.size(); i += i > (std::size_t{4} << 20) && i < (std::size_t{4} << 20) + 5000 ? 3 : 997) {
+		s[i] = 'x';
+		offsets.push_back(i);
+	}
+	auto idx = fsv::rank_index{fsv::filtered_string_view{s, fsv::char_table{[](const char &c) { return c == 'x'; }}}};
+	REQUIRE(idx.size() == offsets.size());
+	for (std::size_t n = 0; n < offsets.size(); ++n) {
+		REQUIRE(idx.select(n) == offsets[n]);
+	}
+	REQUIRE(idx.rank(s.size() / 2) == static_cast<std::size_t>(std::lower_bound(offsets.begin(), offsets.end(), s.size() / 2) - offsets.begin()));
+}
+
+TEST_CASE("rank_index answers at and substr") {
+	auto s = make_text(3000);
+	auto sv = fsv::filtered_string_view{s, [](const char &c) { return c != 'e' && c != 'q'; }};
+	auto idx = fsv::rank_index{sv};
+
+	SECTION("at") {
+		for (int i = 0; i < static_cast<int>(sv.size()); i += 37) {
+			REQUIRE(&fsv::at(sv, i, idx) == &sv.at(i));
+		}
+		REQUIRE_THROWS_AS(fsv::at(sv, -1, idx), std::domain_error);
+		REQUIRE_THROWS_AS(fsv::at(sv, static_cast<int>(sv.size()), idx), std::domain_error);
+	}
+
+	SECTION("substr") {
+		auto sub = fsv::substr(sv, 100, 250, idx);
+		auto expected = fsv::substr(sv, 100, 250);
+		REQUIRE(sub == expected);
+		REQUIRE(sub.data() == expected.data());
+		REQUIRE_THROWS_AS(fsv::substr(sv, static_cast<int>(sv.size()), 0, idx), std::domain_error);
+	}
+
+	SECTION("views of a sub-range") {
+		auto sub = fsv::substr(sv, 1000, 500);
+		REQUIRE(fsv::at(sub, 0, idx) == sub.at(0));
+		REQUIRE(fsv::at(sub, 499, idx) == sub.at(499));
+		REQUIRE_THROWS_AS(fsv::at(sub, 500, idx), std::domain_error);
+		REQUIRE_THROWS_AS(fsv::at(sub, -1, idx), std::domain_error);
+		REQUIRE(fsv::substr(sub, 10, 20, idx) == fsv::substr(sub, 10, 20));
+	}
+
+	SECTION("foreign view") {
+		auto other = std::string{"Ragdoll"};
+		REQUIRE_THROWS_AS(fsv::at(fsv::filtered_string_view{other}, 0, idx), std::domain_error);
+	}
+}
+
+TEST_CASE("rank_index checks the predicate of the views it answers") {
+	auto s = make_text(3000);
+	auto no_e = [](const char &c) { return c != 'e'; };
+	auto no_q = [](const char &c) { return c != 'q'; };
+
+	SECTION("filters must share the index's filter") {
+		auto sv = fsv::filtered_string_view{s, no_e};
+		auto idx = fsv::rank_index{sv};
+		REQUIRE(fsv::at(fsv::substr(sv, 10, 20), 0, idx) == sv.at(10));
+		const auto other = fsv::filtered_string_view{s, no_q};
+		REQUIRE_THROWS_AS(fsv::at(other, 0, idx), std::domain_error);
+		REQUIRE_THROWS_AS(fsv::substr(other, 0, 5, idx), std::domain_error);
+		REQUIRE_THROWS_AS(fsv::indexed(other, idx), std::domain_error);
+		REQUIRE_THROWS_AS(fsv::at(fsv::filtered_string_view{s}, 0, idx), std::domain_error);
+	}
+
+	SECTION("table-backed predicates must keep the same bytes") {
+		auto idx = fsv::rank_index{fsv::filtered_string_view{s, fsv::char_table{no_e}}};
+		REQUIRE(fsv::at(fsv::filtered_string_view{s, fsv::char_table{no_e}}, 5, idx) == fsv::filtered_string_view{s, no_e}.at(5));
+		REQUIRE_THROWS_AS(fsv::at(fsv::filtered_string_view{s, fsv::char_table{no_q}}, 5, idx), std::domain_error);
+		REQUIRE_THROWS_AS(fsv::at(fsv::filtered_string_view{s, no_e}, 5, idx), std::domain_error);
+	}
+
+	SECTION("other predicates must be of the same type") {
+		using view_type = fsv::basic_filtered_string_view<char, decltype(no_e)>;
+		auto sv = view_type{s, no_e};
+		auto idx = fsv::rank_index{sv};
+		REQUIRE(fsv::at(sv, 5, idx) == sv.at(5));
+		REQUIRE_THROWS_AS(fsv::at(fsv::basic_filtered_string_view<char, decltype(no_q)>{s, no_q}, 5, idx), std::domain_error);
+	}
+}
+
+TEST_CASE("rank_index iteration") {
+	auto sv = fsv::filtered_string_view{"The best breed of cats is Ragdoll", [](const char &c) { return c != ' '; }};
+	auto idx = fsv::rank_index{sv};
+
+	SECTION("forward and backward") {
+		auto v = std::vector<char>{idx.begin(), idx.end()};
+		REQUIRE(v == std::vector<char>{sv.begin(), sv.end()});
+		auto it = idx.end();
+		REQUIRE(*--it == 'l');
+	}
+
+	SECTION("random access") {
+		auto range = fsv::indexed(sv, idx);
+		REQUIRE(range.size() == sv.size());
+		REQUIRE(range[3] == 'b');
+		REQUIRE(*(range.begin() + 7) == 'b');
+		REQUIRE(range.end() - range.begin() == static_cast<std::ptrdiff_t>(sv.size()));
+	}
+
+	SECTION("sub-range") {
+		auto sub = fsv::substr(sv, 3, 4);
+		auto range = fsv::indexed(sub, idx);
+		REQUIRE(std::string{range.begin(), range.end()} == "best");
+	}
+}
@@ -0,0 +1,183 @@
+#include "./ring_view.h"
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace fsv {
+	ring_filtered_view::ring_filtered_view(std::string_view ring, std::size_t head, std::size_t len, filter pred)
+	: ring_{ring}, head_{head}, len_{len}, pred_{std::move(pred)} {
+		if (head > ring.size() || len > ring.size()) {
+			throw std::domain_error{"ring_filtered_view(" + std::to_string(head) + ", " + std::to_string(len)
+			                        + "): invalid range"};
+		}
+		head_ = ring.empty() ? 0 : head % ring.size();
+		kept_ = count_(head_, len_);
+		rebuild_();
+	}
+
+	ring_filtered_view::ring_filtered_view(const ring_filtered_view &other)
+	: ring_{other.ring_}, head_{other.head_}, len_{other.len_}, pred_{other.pred_}, kept_{other.kept_},
+	  scanner_{other.scanner_}, scanned_{other.scanned_}, scanned_kept_{other.scanned_kept_}, token_end_{other.token_end_} {
+		rebuild_();
+	}
+
+	auto ring_filtered_view::operator=(const ring_filtered_view &other) -> ring_filtered_view & {
+		if (this != &other) {
+			ring_ = other.ring_;
+			head_ = other.head_;
+			len_ = other.len_;
+			pred_ = other.pred_;
+			kept_ = other.kept_;
+			scanner_ = other.scanner_;
+			scanned_ = other.scanned_;
+			scanned_kept_ = other.scanned_kept_;
+			token_end_ = other.token_end_;
+			rebuild_();
+		}
+		return *this;
+	}
+
+	auto ring_filtered_view::rebuild_() -> void {
+		const auto first_ = std::min(len_, ring_.size() - head_);
+		parts_[0] = ring_.substr(head_, first_);
+		parts_[1] = ring_.substr(0, len_ - first_);
+		view_ = segmented_filtered_view{std::span{parts_}.first(len_ > first_ ? 2 : 1), pred_};
+	}
+
+	auto ring_filtered_view::count_(std::size_t pos, std::size_t n) const -> std::size_t {
+		const auto first_ = std::min(n, ring_.size() - pos);
+		return filtered_string_view{ring_.data() + pos, first_, pred_}.size()
+		       + filtered_string_view{ring_.data(), n - first_, pred_}.size();
+	}
+
+	auto ring_filtered_view::view() const noexcept -> const segmented_filtered_view & {
+		return view_;
+	}
+
+	auto ring_filtered_view::begin() const noexcept -> segmented_filtered_view::iterator {
+		return view_.begin();
+	}
+
+	auto ring_filtered_view::end() const noexcept -> segmented_filtered_view::iterator {
+		return view_.end();
+	}
+
+	ring_filtered_view::operator std::string() const {
+		return static_cast<std::string>(view_);
+	}
+
+	auto ring_filtered_view::size() const noexcept -> std::size_t {
+		return kept_;
+	}
+
+	auto ring_filtered_view::empty() const noexcept -> bool {
+		return kept_ == 0;
+	}
+
+	auto ring_filtered_view::raw_size() const noexcept -> std::size_t {
+		return len_;
+	}
+
+	auto ring_filtered_view::head() const noexcept -> std::size_t {
+		return head_;
+	}
+
+	auto ring_filtered_view::capacity() const noexcept -> std::size_t {
+		return ring_.size();
+	}
+
+	auto ring_filtered_view::append(std::size_t n) -> void {
+		if (n > ring_.size() - len_) {
+			throw std::domain_error{"ring_filtered_view::append(" + std::to_string(n) + "): ring is full"};
+		}
+		if (n == 0) {
+			return;
+		}
+		kept_ += count_((head_ + len_) % ring_.size(), n);
+		len_ += n;
+		rebuild_();
+	}
+
+	auto ring_filtered_view::consume(std::size_t n) -> void {
+		if (n > len_) {
+			throw std::domain_error{"ring_filtered_view::consume(" + std::to_string(n) + "): not enough data"};
+		}
+		if (n == 0) {
+			return;
+		}
+		// what next_token() has scanned is counted already; only other prefixes need a scan
+		if (n == len_) {
+			kept_ = 0;
+		}
+		else if (n == scanned_) {
+			kept_ -= scanned_kept_;
+		}
+		else {
+			kept_ -= count_(head_, n);
+		}
+		// offsets held for next_token() are relative to head_; it starts over from the new head
+		if (scanner_) {
+			scanner_->reset();
+		}
+		scanned_ = 0;
+		scanned_kept_ = 0;
+		token_end_ = 0;
+		head_ = (head_ + n) % ring_.size();
+		len_ -= n;
+		rebuild_();
+	}
+
+	auto ring_filtered_view::next_token(const filtered_string_view &tok) -> std::optional<segmented_filtered_view> {
+		if (token_end_ > 0) {
+			// the scan stopped right after the delimiter, so nothing scanned is lost
+			consume(token_end_);
+		}
+		if (tok.empty()) {
+			throw std::domain_error{"ring_filtered_view::next_token: empty delimiter"};
+		}
+		// the scanner (and its KMP table) is built again only when the delimiter changes
+		if (!scanner_ || tok != filtered_string_view{scanner_->delim()}) {
+			scanner_.emplace(static_cast<std::string>(tok));
+			scanned_ = 0;
+			scanned_kept_ = 0;
+		}
+		const auto found_ = detail::visit_predicate<char>(pred_, [this](const auto &pred) {
+			auto base_ = std::size_t{0};
+			for (auto part : parts_) {
+				for (auto i = scanned_ - std::min(scanned_, base_); base_ + i < len_ && i < part.size(); ++i) {
+					if (!pred(part[i])) {
+						continue;
+					}
+					++scanned_kept_;
+					if (scanner_->feed(part[i], base_ + i)) {
+						scanned_ = base_ + i + 1;
+						return true;
+					}
+				}
+				base_ += part.size();
+			}
+			scanned_ = len_;
+			return false;
+		});
+		if (!found_) {
+			return std::nullopt;
+		}
+		token_end_ = scanned_;
+		const auto [first_, last_] = scanner_->token();
+		return view_.raw_subview(first_, last_);
+	}
+
+	auto operator==(const ring_filtered_view &lhs, const ring_filtered_view &rhs) -> bool {
+		return lhs.view_ == rhs.view_;
+	}
+
+	auto operator<=>(const ring_filtered_view &lhs, const ring_filtered_view &rhs) -> std::strong_ordering {
+		return lhs.view_ <=> rhs.view_;
+	}
+
+	auto split(const ring_filtered_view &ring, const filtered_string_view &tok) -> std::vector<segmented_filtered_view> {
+		return split(ring.view(), tok);
+	}
+}
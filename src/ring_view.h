@@ -0,0 +1,89 @@
+#ifndef COMP6771_ASS2_RING_VIEW_H
+#define COMP6771_ASS2_RING_VIEW_H
+
+#include "./segmented_view.h"
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fsv {
+	// A filtered view of the live part of a circular buffer, for tailing data that a producer
+	// keeps appending to. The live data starts at head and may wrap around the end of the
+	// buffer, so the view is the segmented view over the (at most) two parts.
+	// append() and consume() move the ends as data arrives and is used up; the kept count is
+	// updated from the chars that came or went, and next_token() resumes its scan where it
+	// stopped, so new data is looked at once however often the view is polled.
+	// The buffer is not owned and must outlive the view.
+	class ring_filtered_view {
+	 public:
+		ring_filtered_view() noexcept = default;
+		// the len chars of ring starting at head, wrapping at the end of ring.
+		// Throws std::domain_error if head or len is larger than ring.
+		ring_filtered_view(std::string_view ring, std::size_t head, std::size_t len, filter pred = {});
+		ring_filtered_view(const ring_filtered_view &other);
+		auto operator=(const ring_filtered_view &other) -> ring_filtered_view &;
+		~ring_filtered_view() = default;
+
+		// The live data as a segmented view (for segmented_split_view, say), valid until the
+		// ring view changes.
+		[[nodiscard]] auto view() const noexcept -> const segmented_filtered_view &;
+
+		[[nodiscard]] auto begin() const noexcept -> segmented_filtered_view::iterator;
+		[[nodiscard]] auto end() const noexcept -> segmented_filtered_view::iterator;
+		[[nodiscard]] explicit operator std::string() const;
+
+		// number of kept chars, kept up to date without a scan
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+		[[nodiscard]] auto empty() const noexcept -> bool;
+		[[nodiscard]] auto raw_size() const noexcept -> std::size_t;
+		[[nodiscard]] auto head() const noexcept -> std::size_t;
+		[[nodiscard]] auto capacity() const noexcept -> std::size_t;
+
+		// The producer wrote n more chars after the live data. Only those are scanned.
+		// Throws std::domain_error if they would not fit in the ring.
+		auto append(std::size_t n) -> void;
+		// Drops the first n raw chars of the live data, moving head on. Chars already scanned by
+		// next_token(), or all of the live data, are dropped without a scan.
+		// Throws std::domain_error if there are fewer than n.
+		auto consume(std::size_t n) -> void;
+
+		// The next token ended by tok in the live data, or nullopt if no delimiter has arrived
+		// yet. The token and its delimiter are consumed on the next call, so the token stays
+		// valid until then (or until consume()). Chars already scanned by an earlier call with
+		// the same tok are not scanned again. Throws std::domain_error if tok keeps no chars.
+		[[nodiscard]] auto next_token(const filtered_string_view &tok) -> std::optional<segmented_filtered_view>;
+
+		friend auto operator==(const ring_filtered_view &lhs, const ring_filtered_view &rhs) -> bool;
+		friend auto operator<=>(const ring_filtered_view &lhs, const ring_filtered_view &rhs) -> std::strong_ordering;
+
+	 private:
+		// points parts_ and view_ at the live data
+		auto rebuild_() -> void;
+		// kept chars among the n raw chars of the ring from offset pos, wrapping
+		[[nodiscard]] auto count_(std::size_t pos, std::size_t n) const -> std::size_t;
+
+		std::string_view ring_;
+		std::size_t head_{0};
+		std::size_t len_{0};
+		filter pred_;
+		std::size_t kept_{0};
+		std::array<std::string_view, 2> parts_;
+		segmented_filtered_view view_;
+
+		// next_token() state, with raw offsets relative to head_
+		std::optional<detail::token_scanner> scanner_;
+		std::size_t scanned_{0};      // raw chars scanned so far
+		std::size_t scanned_kept_{0}; // kept chars among them, so that consuming them needs no scan
+		std::size_t token_end_{0};    // chars to consume before scanning on, after a token was handed out
+	};
+
+	// Splits the live data of ring like split(); delimiters may straddle the wrap point.
+	[[nodiscard]] auto split(const ring_filtered_view &ring, const filtered_string_view &tok) -> std::vector<segmented_filtered_view>;
+}
+
+#endif // COMP6771_ASS2_RING_VIEW_H
@@ -0,0 +1,159 @@
+#include "./ring_view.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	// a ring buffer with a producer writing at its tail
+	struct ring_buffer {
+		explicit ring_buffer(std::size_t capacity, std::size_t head = 0)
+		: data(capacity, '\0'), tail{head} {}
+
+		// writes s at the tail, wrapping
+		auto push(const std::string &s) -> void {
+			for (auto c : s) {
+				data[tail] = c;
+				tail = (tail + 1) % data.size();
+			}
+		}
+
+		std::string data;
+		std::size_t tail;
+	};
+
+	auto strings(const std::vector<fsv::segmented_filtered_view> &views) -> std::vector<std::string> {
+		auto res = std::vector<std::string>{};
+		for (const auto &v : views) {
+			res.push_back(static_cast<std::string>(v));
+		}
+		return res;
+	}
+}
+
+TEST_CASE("ring_filtered_view") {
+	auto not_dash = [](const char &c){ return c != '-'; };
+
+	SECTION("reads across the wrap point") {
+		auto buf = ring_buffer{10, 7};
+		buf.push("ab-c,d--e,");
+		const auto ring = fsv::ring_filtered_view{buf.data, 7, 10, not_dash};
+		REQUIRE(ring.view().segment_count() == 2);
+		REQUIRE(ring.size() == 7);
+		REQUIRE(ring.raw_size() == 10);
+		REQUIRE(static_cast<std::string>(ring) == "abc,de,");
+		REQUIRE(std::string(ring.begin(), ring.end()) == "abc,de,");
+		REQUIRE(std::string(ring.view().rbegin(), ring.view().rend()) == ",ed,cba");
+		REQUIRE(strings(fsv::split(ring, ",")) == std::vector<std::string>{"abc", "de", ""});
+		REQUIRE(strings(fsv::split(ring, "c,d")) == std::vector<std::string>{"ab", "e,"});
+
+		auto lazy = std::vector<std::string>{};
+		for (auto token : fsv::segmented_split_view{ring.view(), ","}) {
+			lazy.push_back(static_cast<std::string>(token));
+		}
+		REQUIRE(lazy == std::vector<std::string>{"abc", "de", ""});
+	}
+
+	SECTION("comparison ignores where the data wraps") {
+		auto a = ring_buffer{8, 6};
+		a.push("abcdef");
+		auto b = ring_buffer{6, 0};
+		b.push("ab-cdef");
+		const auto ra = fsv::ring_filtered_view{a.data, 6, 6, not_dash};
+		const auto rb = fsv::ring_filtered_view{b.data, 1, 6, not_dash};
+		REQUIRE(static_cast<std::string>(rb) == "bcdef");
+		REQUIRE(ra != rb);
+		REQUIRE((ra <=> rb) == std::strong_ordering::less);
+		auto c = ring_buffer{8, 3};
+		c.push("abcdef");
+		REQUIRE(ra == fsv::ring_filtered_view{c.data, 3, 6, not_dash});
+	}
+
+	SECTION("append and consume keep the size") {
+		auto buf = ring_buffer{8};
+		auto ring = fsv::ring_filtered_view{buf.data, 0, 0, not_dash};
+		REQUIRE(ring.empty());
+		buf.push("ab-cd-");
+		ring.append(6);
+		REQUIRE(ring.size() == 4);
+		ring.consume(3);
+		REQUIRE(ring.size() == 2);
+		buf.push("e-fg");
+		ring.append(4);
+		REQUIRE(ring.head() == 3);
+		REQUIRE(ring.size() == 5);
+		REQUIRE(static_cast<std::string>(ring) == "cdefg");
+		REQUIRE_THROWS_AS(ring.append(2), std::domain_error);
+		REQUIRE_THROWS_AS(ring.consume(8), std::domain_error);
+
+		// copies have their own parts
+		auto copy = ring;
+		ring.consume(7);
+		REQUIRE(static_cast<std::string>(copy) == "cdefg");
+		REQUIRE(ring.empty());
+	}
+
+	SECTION("next_token tails a stream without rescanning it") {
+		auto calls = std::size_t{0};
+		auto counted = [&calls](const char &c){ ++calls; return c != '-'; };
+		auto gen = std::mt19937{24};
+		auto stream = std::string(20000, ' ');
+		for (auto &c : stream) {
+			c = "ab-;"[gen() % 4];
+		}
+		auto buf = ring_buffer{256};
+		auto ring = fsv::ring_filtered_view{buf.data, 0, 0, counted};
+		auto tokens = std::vector<std::string>{};
+		for (std::size_t pos = 0; pos < stream.size();) {
+			// the producer writes whatever fits, a few chars at a time
+			const auto n = std::min({std::size_t{1} + gen() % 5, ring.capacity() - ring.raw_size(), stream.size() - pos});
+			buf.push(stream.substr(pos, n));
+			ring.append(n);
+			pos += n;
+			while (auto token = ring.next_token(";;")) {
+				// reading the token back is not part of tailing the stream
+				const auto before = calls;
+				tokens.push_back(static_cast<std::string>(*token));
+				calls = before;
+			}
+			// a token longer than the ring would never end; give its data up
+			if (ring.raw_size() == ring.capacity()) {
+				ring.consume(ring.raw_size());
+				tokens.push_back("<dropped>");
+			}
+		}
+		// each char is tested when appended and when scanned, once each
+		REQUIRE(calls <= 2 * stream.size());
+
+		// without overflow, the tokens are those of split() on the whole stream
+		auto expected = strings(std::vector<fsv::segmented_filtered_view>{});
+		const auto segs = std::vector<std::string_view>{stream};
+		const auto all = fsv::split(fsv::segmented_filtered_view{segs, not_dash}, ";;");
+		for (std::size_t i = 0; i + 1 < all.size(); ++i) {
+			expected.push_back(static_cast<std::string>(all[i]));
+		}
+		REQUIRE(std::find(tokens.begin(), tokens.end(), "<dropped>") == tokens.end());
+		REQUIRE(tokens == expected);
+		REQUIRE(tokens.size() > 100);
+	}
+
+	SECTION("next_token across the wrap point") {
+		auto buf = ring_buffer{8, 5};
+		auto ring = fsv::ring_filtered_view{buf.data, 5, 0, not_dash};
+		buf.push("ab;");
+		ring.append(3);
+		REQUIRE_FALSE(ring.next_token(";;"));
+		buf.push(";cd;");
+		ring.append(4);
+		auto token = ring.next_token(";;");
+		REQUIRE(token);
+		REQUIRE(static_cast<std::string>(*token) == "ab");
+		REQUIRE_FALSE(ring.next_token(";;"));
+		REQUIRE(static_cast<std::string>(ring) == "cd;");
+		REQUIRE_THROWS_AS(ring.next_token(""), std::domain_error);
+	}
+}
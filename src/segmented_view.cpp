@@ -0,0 +1,397 @@
+#include "./segmented_view.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace fsv {
+	segmented_filtered_view::segmented_filtered_view(std::span<const std::string_view> segments, filter pred) noexcept
+	: segs_{segments}, tail_{segments.empty() ? 0 : segments.back().size()}, pred_{std::move(pred)} {
+		for (auto seg : segs_) {
+			len_ += seg.size();
+		}
+	}
+
+	segmented_filtered_view::segmented_filtered_view(std::span<const std::string_view> segments, std::size_t skip,
+	                                                 std::size_t tail, std::size_t len, filter pred) noexcept
+	: segs_{segments}, skip_{skip}, tail_{tail}, len_{len}, pred_{std::move(pred)} {}
+
+	auto segmented_filtered_view::begin() const noexcept -> iterator {
+		FSV_STATS_SCOPE(iterate);
+		return iterator{this, false};
+	}
+
+	auto segmented_filtered_view::end() const noexcept -> iterator {
+		return iterator{this, true};
+	}
+
+	auto segmented_filtered_view::rbegin() const noexcept -> reverse_iterator {
+		return reverse_iterator{end()};
+	}
+
+	auto segmented_filtered_view::rend() const noexcept -> reverse_iterator {
+		return reverse_iterator{begin()};
+	}
+
+	segmented_filtered_view::operator std::string() const {
+		FSV_STATS_SCOPE(to_string);
+		auto res_ = std::string{};
+		if (const auto *table_ = pred_.table()) {
+			// each segment is compacted straight after the last, into room for all of them
+			res_.resize(size() + detail::compact_slack);
+			std::size_t k = 0;
+			for (std::size_t i = 0; i < segment_count(); ++i) {
+				const auto seg_ = segment(i);
+				k += detail::compact_kept(seg_.data(), seg_.size(), *table_, res_.data() + k);
+			}
+			res_.resize(k);
+			return res_;
+		}
+		for (std::size_t i = 0; i < segment_count(); ++i) {
+			for (auto c : segment(i)) {
+				if (pred_(c)) {
+					res_ += c;
+				}
+			}
+		}
+		return res_;
+	}
+
+	auto segmented_filtered_view::size() const noexcept -> std::size_t {
+		FSV_STATS_SCOPE(size);
+		std::size_t res_ = 0;
+		const auto *table_ = pred_.table();
+		for (std::size_t i = 0; i < segment_count(); ++i) {
+			const auto seg_ = segment(i);
+			if (table_ != nullptr) {
+				res_ += detail::count_kept(seg_.data(), seg_.size(), *table_);
+			}
+			else {
+				res_ += static_cast<std::size_t>(std::count_if(seg_.begin(), seg_.end(), [this](char c) { return pred_(c); }));
+			}
+		}
+		return res_;
+	}
+
+	auto segmented_filtered_view::empty() const noexcept -> bool {
+		FSV_STATS_SCOPE(empty);
+		return begin() == end();
+	}
+
+	auto segmented_filtered_view::raw_size() const noexcept -> std::size_t {
+		return len_;
+	}
+
+	auto segmented_filtered_view::predicate() const noexcept -> const filter & {
+		return pred_;
+	}
+
+	auto segmented_filtered_view::segment_count() const noexcept -> std::size_t {
+		return segs_.size();
+	}
+
+	auto segmented_filtered_view::segment(std::size_t i) const noexcept -> std::string_view {
+		const auto seg_ = segs_[i];
+		const auto first_ = i == 0 ? skip_ : 0;
+		const auto last_ = i + 1 == segs_.size() ? tail_ : seg_.size();
+		return std::string_view{seg_.data() + first_, last_ - first_};
+	}
+
+	auto segmented_filtered_view::raw_subview(std::size_t first, std::size_t last) const -> segmented_filtered_view {
+		if (first > last || last > len_) {
+			throw std::domain_error{"segmented_filtered_view::raw_subview(" + std::to_string(first) + ", "
+			                        + std::to_string(last) + "): invalid range"};
+		}
+		if (first == last) {
+			return segmented_filtered_view{{}, 0, 0, 0, pred_};
+		}
+		// walk to the segments holding the first and the last char
+		std::size_t a_ = 0;
+		std::size_t start_ = 0;
+		while (first >= start_ + segment(a_).size()) {
+			start_ += segment(a_++).size();
+		}
+		const auto skip_a_ = (a_ == 0 ? skip_ : 0) + first - start_;
+		auto b_ = a_;
+		while (last > start_ + segment(b_).size()) {
+			start_ += segment(b_++).size();
+		}
+		const auto tail_b_ = (b_ == 0 ? skip_ : 0) + last - start_;
+		return segmented_filtered_view{segs_.subspan(a_, b_ - a_ + 1), skip_a_, tail_b_, last - first, pred_};
+	}
+
+	auto segmented_filtered_view::sub_(const std::vector<std::size_t> &starts, std::size_t first, std::size_t last) const
+	    -> segmented_filtered_view {
+		if (first == last) {
+			return segmented_filtered_view{{}, 0, 0, 0, pred_};
+		}
+		// the segments holding the first and the last char; empty segments are never picked
+		const auto a_ = static_cast<std::size_t>(std::upper_bound(starts.begin(), starts.end(), first) - starts.begin()) - 1;
+		const auto b_ = static_cast<std::size_t>(std::upper_bound(starts.begin(), starts.end(), last - 1) - starts.begin()) - 1;
+		const auto offset_ = [this](std::size_t i) { return i == 0 ? skip_ : 0; };
+		return segmented_filtered_view{segs_.subspan(a_, b_ - a_ + 1), offset_(a_) + first - starts[a_],
+		                               offset_(b_) + last - starts[b_], last - first, pred_};
+	}
+
+	auto operator==(const segmented_filtered_view &lhs, const segmented_filtered_view &rhs) -> bool {
+		FSV_STATS_SCOPE(compare);
+		auto l_ = lhs.begin();
+		auto r_ = rhs.begin();
+		const auto lend_ = lhs.end();
+		const auto rend_ = rhs.end();
+		for (; l_ != lend_ && r_ != rend_; ++l_, ++r_) {
+			if (*l_ != *r_) {
+				return false;
+			}
+		}
+		return l_ == lend_ && r_ == rend_;
+	}
+
+	auto operator<=>(const segmented_filtered_view &lhs, const segmented_filtered_view &rhs) -> std::strong_ordering {
+		FSV_STATS_SCOPE(compare);
+		auto l_ = lhs.begin();
+		auto r_ = rhs.begin();
+		const auto lend_ = lhs.end();
+		const auto rend_ = rhs.end();
+		for (; l_ != lend_ && r_ != rend_; ++l_, ++r_) {
+			if (*l_ != *r_) {
+				return *l_ <=> *r_;
+			}
+		}
+		if (l_ == lend_ && r_ == rend_) {
+			return std::strong_ordering::equal;
+		}
+		return l_ == lend_ ? std::strong_ordering::greater : std::strong_ordering::less;
+	}
+
+	auto operator<<(std::ostream &os, const segmented_filtered_view &sv) -> std::ostream & {
+		FSV_STATS_SCOPE(write);
+		detail::visit_predicate<char>(sv.pred_, [&](const auto &pred) {
+			auto done_ = false;
+			for (std::size_t i = 0; i < sv.segment_count() && !done_; ++i) {
+				const auto seg_ = sv.segment(i);
+				detail::for_each_run(seg_.data(), seg_.size(), pred, [&](const char *run, std::size_t n) {
+					const auto *nul_ = std::char_traits<char>::find(run, n, '\0');
+					os.write(run, static_cast<std::streamsize>(nul_ == nullptr ? n : static_cast<std::size_t>(nul_ - run) + 1));
+					done_ = nul_ != nullptr;
+					return !done_;
+				});
+			}
+		});
+		return os;
+	}
+
+	// The kept chars of all segments are fed to a token_scanner in turn.
+	auto split(const segmented_filtered_view &sv, const filtered_string_view &tok) -> std::vector<segmented_filtered_view> {
+		FSV_STATS_SCOPE(split);
+		auto res_ = std::vector<segmented_filtered_view>{};
+		auto delim_ = static_cast<std::string>(tok);
+		if (delim_.empty() || sv.size() < delim_.size()) {
+			res_.push_back(sv);
+			return res_;
+		}
+		auto starts_ = std::vector<std::size_t>(sv.segment_count());
+		for (std::size_t i = 1; i < starts_.size(); ++i) {
+			starts_[i] = starts_[i - 1] + sv.segment(i - 1).size();
+		}
+		auto scanner_ = detail::token_scanner{std::move(delim_)};
+		detail::visit_predicate<char>(sv.predicate(), [&](const auto &pred) {
+			for (std::size_t i = 0; i < sv.segment_count(); ++i) {
+				const auto seg_ = sv.segment(i);
+				for (std::size_t j = 0; j < seg_.size(); ++j) {
+					if (pred(seg_[j]) && scanner_.feed(seg_[j], starts_[i] + j)) {
+						const auto [first_, last_] = scanner_.token();
+						res_.push_back(sv.sub_(starts_, first_, last_));
+						scanner_.reset();
+					}
+				}
+			}
+		});
+		const auto [first_, last_] = scanner_.token();
+		res_.push_back(sv.sub_(starts_, first_, last_));
+		return res_;
+	}
+
+	namespace detail {
+		token_scanner::token_scanner(std::string delim)
+		: delim_{std::move(delim)}, fail_{kmp_failure(delim_)}, recent_(delim_.size() + 1) {}
+
+		auto token_scanner::feed(char c, std::size_t offset) -> bool {
+			if (kept_ == 0) {
+				first_ = offset;
+			}
+			recent_[kept_ % recent_.size()] = offset;
+			++kept_;
+			while (k_ > 0 && c != delim_[k_]) {
+				k_ = fail_[k_ - 1];
+			}
+			if (c == delim_[k_]) {
+				++k_;
+			}
+			matched_ = k_ == delim_.size();
+			return matched_;
+		}
+
+		auto token_scanner::token() const noexcept -> std::pair<std::size_t, std::size_t> {
+			const auto n_ = matched_ ? kept_ - delim_.size() : kept_;
+			if (n_ == 0) {
+				return {0, 0};
+			}
+			return {first_, recent_[(n_ - 1) % recent_.size()] + 1};
+		}
+
+		auto token_scanner::reset() noexcept -> void {
+			k_ = 0;
+			kept_ = 0;
+			matched_ = false;
+		}
+
+		auto token_scanner::delim() const noexcept -> const std::string & {
+			return delim_;
+		}
+	}
+
+	segmented_split_view::segmented_split_view(const segmented_filtered_view &sv, const filtered_string_view &tok)
+	: sv_{sv}, delim_{static_cast<std::string>(tok)}, starts_(sv.segment_count()),
+	  whole_{delim_.empty() || sv_.size() < delim_.size()} {
+		for (std::size_t i = 1; i < starts_.size(); ++i) {
+			starts_[i] = starts_[i - 1] + sv_.segment(i - 1).size();
+		}
+	}
+
+	auto segmented_split_view::begin() const -> iterator {
+		return iterator{this, 0};
+	}
+
+	auto segmented_split_view::end() const noexcept -> iterator {
+		return iterator{};
+	}
+
+	segmented_split_view::iter::iter(const segmented_split_view *parent, std::size_t from)
+	: parent_{parent}, at_end_{false} {
+		if (parent_->whole_) {
+			from_ = from;
+			last_ = true;
+			return;
+		}
+		scanner_.emplace(parent_->delim_);
+		scan_(from);
+	}
+
+	auto segmented_split_view::iter::scan_(std::size_t from) -> void {
+		const auto &sv_ = parent_->sv_;
+		const auto &starts_ = parent_->starts_;
+		from_ = from;
+		scanner_->reset();
+		const auto first_seg_ = static_cast<std::size_t>(std::upper_bound(starts_.begin(), starts_.end(), from) - starts_.begin());
+		last_ = detail::visit_predicate<char>(sv_.predicate(), [&](const auto &pred) {
+			for (auto i = first_seg_ == 0 ? 0 : first_seg_ - 1; i < sv_.segment_count(); ++i) {
+				const auto seg_ = sv_.segment(i);
+				for (auto j = from > starts_[i] ? from - starts_[i] : 0; j < seg_.size(); ++j) {
+					if (pred(seg_[j]) && scanner_->feed(seg_[j], starts_[i] + j)) {
+						next_ = starts_[i] + j + 1;
+						return false;
+					}
+				}
+			}
+			return true;
+		});
+		token_ = scanner_->token();
+	}
+
+	auto segmented_split_view::iter::operator*() const -> reference {
+		if (parent_->whole_) {
+			return parent_->sv_;
+		}
+		return parent_->sv_.sub_(parent_->starts_, token_.first, token_.second);
+	}
+
+	auto segmented_split_view::iter::operator++() -> iter & {
+		if (last_) {
+			*this = iter{};
+		}
+		else {
+			scan_(next_);
+		}
+		return *this;
+	}
+
+	auto segmented_split_view::iter::operator++(int) -> iter {
+		auto copy_ = *this;
+		++*this;
+		return copy_;
+	}
+
+	segmented_filtered_view::iter::iter(const segmented_filtered_view *sv, bool ending) noexcept
+	: sv_{sv}, table_{sv->pred_.table()} {
+		if (ending || sv_->segment_count() == 0) {
+			seg_ = sv_->segment_count();
+			return;
+		}
+		ptr_ = sv_->segment(0).data();
+		settle_();
+	}
+
+	auto segmented_filtered_view::iter::settle_() -> void {
+		const auto n_ = sv_->segment_count();
+		while (seg_ < n_) {
+			const auto seg_data_ = sv_->segment(seg_);
+			const auto *end_ = seg_data_.data() + seg_data_.size();
+			if (table_ != nullptr) {
+				ptr_ += detail::find_kept(ptr_, static_cast<std::size_t>(end_ - ptr_), *table_);
+			}
+			else {
+				while (ptr_ != end_ && !keep_(*ptr_)) {
+					++ptr_;
+				}
+			}
+			if (ptr_ != end_) {
+				return;
+			}
+			++seg_;
+			ptr_ = seg_ < n_ ? sv_->segment(seg_).data() : nullptr;
+		}
+	}
+
+	auto segmented_filtered_view::iter::keep_(char c) const -> bool {
+		return table_ != nullptr ? table_->test(c) : sv_->pred_(c);
+	}
+
+	auto segmented_filtered_view::iter::operator*() const -> reference {
+		return *ptr_;
+	}
+
+	auto segmented_filtered_view::iter::operator++() -> iter & {
+		FSV_STATS_SCOPE(iterate);
+		++ptr_;
+		settle_();
+		return *this;
+	}
+
+	auto segmented_filtered_view::iter::operator++(int) -> iter {
+		auto copy_ = *this;
+		++*this;
+		return copy_;
+	}
+
+	// there must be a kept char before the current position
+	auto segmented_filtered_view::iter::operator--() -> iter & {
+		FSV_STATS_SCOPE(iterate);
+		do {
+			while (seg_ == sv_->segment_count() || ptr_ == sv_->segment(seg_).data()) {
+				--seg_;
+				const auto seg_data_ = sv_->segment(seg_);
+				ptr_ = seg_data_.data() + seg_data_.size();
+			}
+			--ptr_;
+		} while (!keep_(*ptr_));
+		return *this;
+	}
+
+	auto segmented_filtered_view::iter::operator--(int) -> iter {
+		auto copy_ = *this;
+		--*this;
+		return copy_;
+	}
+}
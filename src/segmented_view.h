@@ -0,0 +1,203 @@
+#ifndef COMP6771_ASS2_SEGMENTED_VIEW_H
+#define COMP6771_ASS2_SEGMENTED_VIEW_H
+
+#include "./filtered_string_view.h"
+
+#include <compare>
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fsv {
+	namespace detail {
+		// KMP over kept chars fed one at a time, keeping track of where the kept chars of the
+		// current token lie in the raw data so that it can be cut out once a delimiter ends it.
+		// The delimiter must not be empty.
+		class token_scanner {
+		 public:
+			explicit token_scanner(std::string delim);
+
+			// Feeds the kept char c found at raw offset; true if it completes a delimiter, after
+			// which token() is the token before it until the next reset().
+			auto feed(char c, std::size_t offset) -> bool;
+			// raw [first, last) of the current token, trimmed to its kept chars; {0, 0} if it has none
+			[[nodiscard]] auto token() const noexcept -> std::pair<std::size_t, std::size_t>;
+			// starts a new token
+			auto reset() noexcept -> void;
+			[[nodiscard]] auto delim() const noexcept -> const std::string &;
+
+		 private:
+			std::string delim_;
+			std::vector<std::size_t> fail_;
+			std::vector<std::size_t> recent_; // raw offsets of the last delim_.size() + 1 kept chars
+			std::size_t k_{0};                // length of the delimiter prefix matched so far
+			std::size_t kept_{0};             // kept chars since the last reset
+			std::size_t first_{0};            // raw offset of the first of them
+			bool matched_{false};
+		};
+	}
+
+	// A filtered view of data scattered over several buffers, e.g. a list of network packets,
+	// read as if the buffers were concatenated.
+	// Sizes, iteration, comparison, split and conversion behave as for filtered_string_view
+	// over the concatenation, without it ever being built: tokens that cross from one buffer to
+	// the next are views over the same buffers. Neither the segment list nor the buffers are
+	// owned, and both must outlive the view and everything split from it.
+	class segmented_filtered_view {
+		class iter {
+		 public:
+			using difference_type = std::ptrdiff_t;
+			using value_type = char;
+			using pointer = void;
+			using reference = const char &;
+			using iterator_category = std::bidirectional_iterator_tag;
+
+			iter() = default;
+			// begin iterators move to the first kept char; end iterators sit past the last segment
+			iter(const segmented_filtered_view *sv, bool ending) noexcept;
+
+			auto operator*() const -> reference;
+
+			auto operator++() -> iter&;
+			auto operator++(int) -> iter;
+			auto operator--() -> iter&;
+			auto operator--(int) -> iter;
+
+			friend auto operator==(const iter &lhs, const iter &rhs) -> bool {
+				return lhs.seg_ == rhs.seg_ && lhs.ptr_ == rhs.ptr_;
+			}
+
+		 private:
+			// moves forward from ptr_ to the next kept char, or to the end
+			auto settle_() -> void;
+			[[nodiscard]] auto keep_(char c) const -> bool;
+
+			const segmented_filtered_view *sv_{nullptr};
+			const char_table *table_{nullptr}; // set when the filter is backed by a char_table
+			std::size_t seg_{0};               // current segment, or segment_count() at the end
+			const char *ptr_{nullptr};         // current kept char, or nullptr at the end
+		};
+
+	 public:
+		using value_type = char;
+		using iterator = iter;
+		using const_iterator = iter;
+		using reverse_iterator = std::reverse_iterator<iter>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		segmented_filtered_view() noexcept = default;
+		// the concatenation of segments, filtered by pred
+		explicit segmented_filtered_view(std::span<const std::string_view> segments, filter pred = {}) noexcept;
+
+		[[nodiscard]] auto begin() const noexcept -> iterator;
+		[[nodiscard]] auto end() const noexcept -> iterator;
+		[[nodiscard]] auto rbegin() const noexcept -> reverse_iterator;
+		[[nodiscard]] auto rend() const noexcept -> reverse_iterator;
+
+		[[nodiscard]] explicit operator std::string() const;
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+		[[nodiscard]] auto empty() const noexcept -> bool;
+		// number of chars over all segments, filtering ignored
+		[[nodiscard]] auto raw_size() const noexcept -> std::size_t;
+		[[nodiscard]] auto predicate() const noexcept -> const filter &;
+
+		// The raw data of the view in segment i, where i < segment_count(). The first and last
+		// segments may be parts of the buffers the view was made from.
+		[[nodiscard]] auto segment_count() const noexcept -> std::size_t;
+		[[nodiscard]] auto segment(std::size_t i) const noexcept -> std::string_view;
+		// The view over raw chars [first, last), over the same buffers.
+		// Throws std::domain_error unless first <= last <= raw_size().
+		[[nodiscard]] auto raw_subview(std::size_t first, std::size_t last) const -> segmented_filtered_view;
+
+		friend auto operator==(const segmented_filtered_view &lhs, const segmented_filtered_view &rhs) -> bool;
+		// ordered like filtered_string_view, where a prefix ranks above the longer view
+		friend auto operator<=>(const segmented_filtered_view &lhs, const segmented_filtered_view &rhs) -> std::strong_ordering;
+		// like filtered_string_view, output stops after the first kept null char
+		friend auto operator<<(std::ostream &os, const segmented_filtered_view &sv) -> std::ostream &;
+
+		friend auto split(const segmented_filtered_view &sv, const filtered_string_view &tok) -> std::vector<segmented_filtered_view>;
+		friend class segmented_split_view;
+
+	 private:
+		segmented_filtered_view(std::span<const std::string_view> segments, std::size_t skip, std::size_t tail,
+		                        std::size_t len, filter pred) noexcept;
+
+		// the view over raw offsets [first, last), where starts holds the raw offset of each segment
+		[[nodiscard]] auto sub_(const std::vector<std::size_t> &starts, std::size_t first, std::size_t last) const
+		    -> segmented_filtered_view;
+
+		std::span<const std::string_view> segs_; // every buffer the view touches
+		std::size_t skip_{0};                    // chars of segs_.front() before the view starts
+		std::size_t tail_{0};                    // chars of segs_.back() up to where the view ends
+		std::size_t len_{0};
+		filter pred_;
+	};
+
+	// Splits sv like split() does a filtered_string_view; delimiters may straddle segments.
+	[[nodiscard]] auto split(const segmented_filtered_view &sv, const filtered_string_view &tok) -> std::vector<segmented_filtered_view>;
+
+	// Lazy counterpart of split() for segmented views, like split_view for filtered_string_view:
+	// tokens are found one at a time as the range is walked. The segments of sv must outlive it.
+	class segmented_split_view : public std::ranges::view_interface<segmented_split_view> {
+		class iter {
+		 public:
+			using value_type = segmented_filtered_view;
+			using difference_type = std::ptrdiff_t;
+			using reference = value_type;
+			using iterator_category = std::input_iterator_tag; // tokens are made on dereference
+			using iterator_concept = std::forward_iterator_tag;
+
+			iter() = default;
+			// the token starting at raw offset from
+			iter(const segmented_split_view *parent, std::size_t from);
+
+			auto operator*() const -> reference;
+
+			auto operator++() -> iter&;
+			auto operator++(int) -> iter;
+
+			friend auto operator==(const iter &lhs, const iter &rhs) -> bool {
+				return lhs.at_end_ == rhs.at_end_ && (lhs.at_end_ || lhs.from_ == rhs.from_);
+			}
+
+		 private:
+			// finds the token starting at raw offset from, reusing scanner_
+			auto scan_(std::size_t from) -> void;
+
+			const segmented_split_view *parent_{nullptr};
+			// built once per walk and reset between tokens; empty at the end or for a whole-view split
+			std::optional<detail::token_scanner> scanner_;
+			std::size_t from_{0};
+			std::pair<std::size_t, std::size_t> token_{0, 0}; // raw range of the current token
+			std::size_t next_{0};                             // raw offset past the delimiter ending it
+			bool last_{false};                                // no delimiter ends it
+			bool at_end_{true};
+		};
+
+	 public:
+		using iterator = iter;
+		using const_iterator = iter;
+
+		segmented_split_view() = default;
+		segmented_split_view(const segmented_filtered_view &sv, const filtered_string_view &tok);
+
+		[[nodiscard]] auto begin() const -> iterator;
+		[[nodiscard]] auto end() const noexcept -> iterator;
+
+	 private:
+		segmented_filtered_view sv_;
+		std::string delim_;
+		std::vector<std::size_t> starts_; // raw offset of each segment of sv_
+		bool whole_{true};                // like split(), sv_ is the only token
+	};
+}
+
+#endif // COMP6771_ASS2_SEGMENTED_VIEW_H
@@ -0,0 +1,126 @@
+#include "./segmented_view.h"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	// s cut at random points into segments, some of them empty
+	auto cut(const std::string &s, std::mt19937 &gen) -> std::vector<std::string_view> {
+		auto res = std::vector<std::string_view>{};
+		for (std::size_t i = 0; i < s.size();) {
+			const auto n = std::min<std::size_t>(gen() % 8, s.size() - i);
+			res.emplace_back(s.data() + i, n);
+			i += n;
+		}
+		return res;
+	}
+
+	// whether every segment of sv lies within one of bufs
+	auto points_into(const fsv::segmented_filtered_view &sv, const std::vector<std::string_view> &bufs) -> bool {
+		for (std::size_t i = 0; i < sv.segment_count(); ++i) {
+			const auto seg = sv.segment(i);
+			auto found = false;
+			for (auto buf : bufs) {
+				found = found || (seg.data() >= buf.data() && seg.data() + seg.size() <= buf.data() + buf.size());
+			}
+			if (!found) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST_CASE("segmented_filtered_view") {
+	auto not_dash = [](const char &c){ return c != '-'; };
+
+	SECTION("reads as the concatenation of its segments") {
+		const auto segs = std::vector<std::string_view>{"ab-", "", "-c", "d--", "e"};
+		const auto sv = fsv::segmented_filtered_view{segs, not_dash};
+		REQUIRE(sv.size() == 5);
+		REQUIRE(sv.raw_size() == 9);
+		REQUIRE_FALSE(sv.empty());
+		REQUIRE(static_cast<std::string>(sv) == "abcde");
+		REQUIRE(std::string(sv.begin(), sv.end()) == "abcde");
+		REQUIRE(std::string(sv.rbegin(), sv.rend()) == "edcba");
+		auto os = std::ostringstream{};
+		os << sv;
+		REQUIRE(os.str() == "abcde");
+	}
+
+	SECTION("empty views") {
+		REQUIRE(fsv::segmented_filtered_view{}.empty());
+		REQUIRE(fsv::segmented_filtered_view{}.begin() == fsv::segmented_filtered_view{}.end());
+		const auto segs = std::vector<std::string_view>{"--", "", "-"};
+		const auto sv = fsv::segmented_filtered_view{segs, not_dash};
+		REQUIRE(sv.empty());
+		REQUIRE(sv.size() == 0);
+		REQUIRE(sv == fsv::segmented_filtered_view{});
+	}
+
+	SECTION("comparison follows filtered_string_view") {
+		const auto a = std::vector<std::string_view>{"ab", "c"};
+		const auto b = std::vector<std::string_view>{"a", "bd"};
+		const auto prefix = std::vector<std::string_view>{"a", "b"};
+		REQUIRE(fsv::segmented_filtered_view{a} < fsv::segmented_filtered_view{b});
+		REQUIRE(fsv::segmented_filtered_view{a} == fsv::segmented_filtered_view{std::vector<std::string_view>{"a-b", "-c"}, not_dash});
+		REQUIRE(fsv::segmented_filtered_view{prefix} > fsv::segmented_filtered_view{a});
+		REQUIRE(fsv::filtered_string_view{"ab"} > fsv::filtered_string_view{"abc"});
+	}
+
+	SECTION("delimiters may straddle segments") {
+		const auto segs = std::vector<std::string_view>{"one,", "-,two,,", ",thr", "ee"};
+		const auto sv = fsv::segmented_filtered_view{segs, not_dash};
+		const auto tokens = fsv::split(sv, ",,");
+		REQUIRE(tokens.size() == 3);
+		REQUIRE(static_cast<std::string>(tokens[0]) == "one");
+		REQUIRE(static_cast<std::string>(tokens[1]) == "two");
+		REQUIRE(static_cast<std::string>(tokens[2]) == ",three");
+		REQUIRE(tokens[2].segment_count() == 2);
+		REQUIRE(points_into(tokens[2], segs));
+	}
+
+	SECTION("agrees with filtered_string_view across random inputs") {
+		auto gen = std::mt19937{23};
+		for (auto i = 0; i < 300; ++i) {
+			auto s = std::string(gen() % 120, ' ');
+			for (auto &c : s) {
+				c = "ab,-"[gen() % 4];
+			}
+			const auto segs = cut(s, gen);
+			const auto delim = std::string{std::vector<std::string>{",", "a,", ",-,", "ab"}[gen() % 4]};
+			for (const auto &pred : {fsv::filter{not_dash}, fsv::filter{fsv::char_table{not_dash}}}) {
+				const auto sv = fsv::segmented_filtered_view{segs, pred};
+				const auto flat = fsv::filtered_string_view{s, pred};
+				REQUIRE(sv.size() == flat.size());
+				REQUIRE(static_cast<std::string>(sv) == static_cast<std::string>(flat));
+				REQUIRE(std::string(sv.rbegin(), sv.rend()) == std::string(flat.rbegin(), flat.rend()));
+
+				const auto tokens = fsv::split(sv, delim);
+				const auto flat_tokens = fsv::split(flat, delim);
+				REQUIRE(tokens.size() == flat_tokens.size());
+				for (std::size_t t = 0; t < tokens.size(); ++t) {
+					REQUIRE(static_cast<std::string>(tokens[t]) == static_cast<std::string>(flat_tokens[t]));
+					REQUIRE(tokens[t].raw_size() == flat_tokens[t].raw_size());
+					REQUIRE(points_into(tokens[t], segs));
+				}
+				auto lazy = std::size_t{0};
+				for (auto token : fsv::segmented_split_view{sv, delim}) {
+					REQUIRE(lazy < tokens.size());
+					REQUIRE(static_cast<std::string>(token) == static_cast<std::string>(tokens[lazy]));
+					REQUIRE(token.raw_size() == tokens[lazy].raw_size());
+					++lazy;
+				}
+				REQUIRE(lazy == tokens.size());
+				if (tokens.size() >= 2) {
+					REQUIRE((tokens[0] <=> tokens[1]) == (flat_tokens[0] <=> flat_tokens[1]));
+					REQUIRE((tokens[0] == tokens[1]) == (flat_tokens[0] == flat_tokens[1]));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,246 @@
+#ifndef COMP6771_ASS2_SPLIT_VIEW_H
+#define COMP6771_ASS2_SPLIT_VIEW_H
+
+#include "./filtered_string_view.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fsv {
+	// Lazy counterpart of split(): a forward range whose tokens are found one at a time as
+	// the range is walked, so reading the first few fields of a record scans only that far.
+	// Yields the same tokens as split(). The delimiter and its KMP failure table are made
+	// once, with the range, and kept inside it when the delimiter has at most inline_delim
+	// kept chars, so that one range per record allocates nothing; longer ones go on the heap.
+	// The data of fsv is not owned and must outlive the range.
+	template<typename CharT, typename Pred, typename TokPred>
+	class split_view : public std::ranges::view_interface<split_view<CharT, Pred, TokPred>> {
+		class iter {
+		 public:
+			using value_type = basic_filtered_string_view<CharT, Pred>;
+			using difference_type = std::ptrdiff_t;
+			using reference = value_type;
+			using iterator_category = std::input_iterator_tag; // tokens are made on dereference
+			using iterator_concept = std::forward_iterator_tag;
+
+			iter() = default;
+			iter(const split_view *parent, std::size_t first);
+
+			auto operator*() const -> reference;
+
+			auto operator++() -> iter&;
+			auto operator++(int) -> iter;
+
+			friend auto operator==(const iter &lhs, const iter &rhs) -> bool {
+				return lhs.at_end_ == rhs.at_end_ && (lhs.at_end_ || lhs.first_ == rhs.first_);
+			}
+
+		 private:
+			const split_view *parent_{nullptr};
+			std::size_t first_{0}; // raw offset where the current token starts
+			std::size_t hit_{0};   // raw offset of the delimiter ending it, or raw_size() for the last token
+			std::size_t next_{0};  // raw offset just past that delimiter
+			bool whole_{false};    // like split(), the only token is the untrimmed view
+			bool at_end_{true};
+		};
+
+	 public:
+		using view_type = basic_filtered_string_view<CharT, Pred>;
+		using iterator = iter;
+		using const_iterator = iter;
+
+		// longest delimiter kept inside the range rather than on the heap
+		static constexpr std::size_t inline_delim = 16;
+
+		split_view() = default;
+		split_view(const view_type &fsv, const basic_filtered_string_view<CharT, TokPred> &tok);
+
+		[[nodiscard]] auto begin() const -> iterator;
+		[[nodiscard]] auto end() const noexcept -> iterator;
+
+	 private:
+		// {raw offset of the first delimiter match at or after from, raw offset just past it};
+		// {raw_size(), raw_size()} if there is none
+		[[nodiscard]] auto match_(std::size_t from) const -> std::pair<std::size_t, std::size_t>;
+		// the token over the raw range [first, last), trimmed to its kept chars
+		[[nodiscard]] auto token_(std::size_t first, std::size_t last) const -> view_type;
+		// whether fsv_ keeps fewer chars than the delimiter, which split() returns whole
+		[[nodiscard]] auto shorter_than_delim_() const -> bool;
+
+		[[nodiscard]] auto delim_data_() const noexcept -> const CharT * {
+			return delim_size_ <= inline_delim ? delim_buf_.data() : delim_heap_.data();
+		}
+		[[nodiscard]] auto fail_data_() const noexcept -> const std::size_t * {
+			return delim_size_ <= inline_delim ? fail_buf_.data() : fail_heap_.data();
+		}
+
+		view_type fsv_;
+		std::size_t delim_size_{0}; // kept chars of tok
+		// the kept chars of tok and their KMP failure table, inline or on the heap
+		std::array<CharT, inline_delim> delim_buf_{};
+		std::array<std::size_t, inline_delim> fail_buf_{};
+		std::basic_string<CharT> delim_heap_;
+		std::vector<std::size_t> fail_heap_;
+	};
+
+	template<typename CharT, typename Pred, typename TokPred>
+	split_view(const basic_filtered_string_view<CharT, Pred> &, const basic_filtered_string_view<CharT, TokPred> &)
+	    -> split_view<CharT, Pred, TokPred>;
+
+	template<typename CharT, typename Pred, typename TokPred>
+	split_view<CharT, Pred, TokPred>::split_view(const view_type &fsv, const basic_filtered_string_view<CharT, TokPred> &tok)
+: fsv_{fsv} {
+		FSV_STATS_SCOPE(split);
+		delim_size_ = tok.size();
+		if (delim_size_ <= inline_delim) {
+			auto *out_ = delim_buf_.data();
+			for (const auto run : tok.runs()) {
+				out_ = std::copy(run.begin(), run.end(), out_);
+			}
+			detail::kmp_failure(delim_buf_.data(), delim_size_, fail_buf_.data());
+		}
+		else {
+			delim_heap_ = static_cast<std::basic_string<CharT>>(tok); // counts its own allocation
+			fail_heap_ = detail::kmp_failure(delim_heap_);
+			stats::note_allocation();
+		}
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::begin() const -> iterator {
+		return iterator{this, 0};
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::end() const noexcept -> iterator {
+		return iterator{};
+	}
+
+	// KMP over the kept chars of fsv, as in split(). While nothing of the delimiter has been
+	// matched, char_traits::find (memchr for char) skips to the next raw occurrence of its
+	// first char.
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::match_(std::size_t from) const -> std::pair<std::size_t, std::size_t> {
+		const auto *ptr_ = fsv_.data();
+		const auto len_ = fsv_.raw_size();
+		const auto m_ = delim_size_;
+		const auto *delim_ = delim_data_();
+		const auto *fail_ = fail_data_();
+		return detail::visit_predicate<CharT>(fsv_.predicate(), [&](const auto &pred) -> std::pair<std::size_t, std::size_t> {
+			if (!pred(delim_[0])) {
+				return {len_, len_};
+			}
+			std::size_t k = 0;
+			for (auto i = from; i < len_; ++i) {
+				if (k == 0) {
+					const auto *hit_ = std::char_traits<CharT>::find(ptr_ + i, len_ - i, delim_[0]);
+					if (hit_ == nullptr) {
+						break;
+					}
+					i = static_cast<std::size_t>(hit_ - ptr_);
+				}
+				if (!pred(ptr_[i])) {
+					continue;
+				}
+				while (k > 0 && ptr_[i] != delim_[k]) {
+					k = fail_[k - 1];
+				}
+				if (ptr_[i] == delim_[k]) {
+					++k;
+				}
+				if (k == m_) {
+					// walk back over the match to find where it starts in the raw data
+					auto start_ = i;
+					for (std::size_t kept_ = 1; kept_ < m_; ) {
+						--start_;
+						if (pred(ptr_[start_])) {
+							++kept_;
+						}
+					}
+					return {start_, i + 1};
+				}
+			}
+			return {len_, len_};
+		});
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::token_(std::size_t first, std::size_t last) const -> view_type {
+		const auto *ptr_ = fsv_.data();
+		detail::visit_predicate<CharT>(fsv_.predicate(), [&](const auto &pred) {
+			while (first < last && !pred(ptr_[first])) {
+				++first;
+			}
+			while (last > first && !pred(ptr_[last - 1])) {
+				--last;
+			}
+		});
+		if (first == last) {
+			return view_type{ptr_, 0, fsv_.predicate()};
+		}
+		return view_type{ptr_ + first, last - first, fsv_.predicate()};
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::shorter_than_delim_() const -> bool {
+		const auto *ptr_ = fsv_.data();
+		const auto len_ = fsv_.raw_size();
+		return detail::visit_predicate<CharT>(fsv_.predicate(), [&](const auto &pred) {
+			std::size_t kept_ = 0;
+			for (std::size_t i = 0; i < len_ && kept_ < delim_size_; ++i) {
+				kept_ += pred(ptr_[i]) ? 1u : 0u;
+			}
+			return kept_ < delim_size_;
+		});
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	split_view<CharT, Pred, TokPred>::iter::iter(const split_view *parent, std::size_t first)
+	: parent_{parent}, first_{first}, at_end_{false} {
+		const auto len_ = parent_->fsv_.raw_size();
+		if (parent_->delim_size_ == 0) {
+			hit_ = next_ = len_;
+			whole_ = true;
+		}
+		else {
+			std::tie(hit_, next_) = parent_->match_(first_);
+			// no match anywhere; checked only then, so that a partial walk never counts the view
+			whole_ = first_ == 0 && hit_ == len_ && parent_->shorter_than_delim_();
+		}
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::iter::operator*() const -> reference {
+		if (whole_) {
+			return parent_->fsv_;
+		}
+		return parent_->token_(first_, hit_);
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::iter::operator++() -> iter & {
+		if (hit_ == parent_->fsv_.raw_size()) {
+			*this = iter{};
+		}
+		else {
+			*this = iter{parent_, next_};
+		}
+		return *this;
+	}
+
+	template<typename CharT, typename Pred, typename TokPred>
+	auto split_view<CharT, Pred, TokPred>::iter::operator++(int) -> iter {
+		auto copy_ = *this;
+		++*this;
+		return copy_;
+	}
+}
+
+#endif // COMP6771_ASS2_SPLIT_VIEW_H
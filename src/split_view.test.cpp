@@ -0,0 +1,111 @@
+#include "./split_view.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <vector>
+
+namespace {
+	template<typename Range>
+	auto strings(const Range &r) -> std::vector<std::string> {
+		auto res = std::vector<std::string>{};
+		for (const auto &piece : r) {
+			res.push_back(static_cast<std::string>(piece));
+		}
+		return res;
+	}
+}
+
+TEST_CASE("split_view is a lazy forward range") {
+	using range_type = fsv::split_view<char, fsv::filter, fsv::filter>;
+	STATIC_REQUIRE(std::ranges::forward_range<range_type>);
+	STATIC_REQUIRE(std::ranges::view<range_type>);
+	STATIC_REQUIRE(std::forward_iterator<range_type::iterator>);
+}
+
+TEST_CASE("split_view yields the same tokens as split") {
+	auto no_stars = [](const char &c){ return c != '*'; };
+	const auto cases = std::vector<std::pair<fsv::filtered_string_view, fsv::filtered_string_view>>{
+		{fsv::filtered_string_view{"The best breed of cats is Ragdoll"}, fsv::filtered_string_view{" "}},
+		{fsv::filtered_string_view{"0x00"}, fsv::filtered_string_view{"0"}},
+		{fsv::filtered_string_view{"00"}, fsv::filtered_string_view{"0"}},
+		{fsv::filtered_string_view{"xx, yy, , zz, "}, fsv::filtered_string_view{", "}},
+		{fsv::filtered_string_view{"a,,,b"}, fsv::filtered_string_view{",,"}},
+		{fsv::filtered_string_view{"*ab,* cd*,*, *ef", no_stars}, fsv::filtered_string_view{", "}},
+		{fsv::filtered_string_view{"a,b", [](const char &c){ return c != ','; }}, fsv::filtered_string_view{","}},
+		{fsv::filtered_string_view{"a, b"}, fsv::filtered_string_view{"; "}},
+		{fsv::filtered_string_view{"a, b"}, fsv::filtered_string_view{""}},
+		{fsv::filtered_string_view{""}, fsv::filtered_string_view{","}},
+		{fsv::filtered_string_view{"a*b,c"}, fsv::filtered_string_view{"b*,", no_stars}},
+		{fsv::filtered_string_view{"x<-- a long delimiter -->y<-- a long*delimiter -->", no_stars},
+		 fsv::filtered_string_view{"<-- a long delimiter -->"}},
+	};
+	for (const auto &[sv, tok] : cases) {
+		REQUIRE(strings(fsv::split_view{sv, tok}) == strings(fsv::split(sv, tok)));
+	}
+}
+
+TEST_CASE("split_view returns views shorter than the delimiter untrimmed, as split does") {
+	auto no_stars = [](const char &c){ return c != '*'; };
+	const auto sv = fsv::filtered_string_view{"**a*", no_stars};
+	const auto tok = fsv::filtered_string_view{"ab"};
+	const auto expected = fsv::split(sv, tok);
+	REQUIRE(expected.size() == 1);
+	auto tokens = fsv::split_view{sv, tok};
+	auto it = tokens.begin();
+	REQUIRE((*it).data() == expected[0].data());
+	REQUIRE((*it).raw_size() == expected[0].raw_size());
+	REQUIRE((*it).raw_size() == 4);
+	REQUIRE(++it == tokens.end());
+
+	// as long as the delimiter but unmatched: trimmed, in both
+	const auto trimmed = fsv::filtered_string_view{"*ac*", no_stars};
+	REQUIRE((*fsv::split_view{trimmed, tok}.begin()).raw_size() == fsv::split(trimmed, tok)[0].raw_size());
+}
+
+TEST_CASE("split_view on runs of the delimiter's first char") {
+	auto no_stars = [](const char &c){ return c != '*'; };
+	auto text = std::string{};
+	for (int i = 0; i < 200; ++i) {
+		text += std::string(static_cast<std::size_t>(i % 37), 'a') + (i % 3 == 0 ? "*a*ab" : "*b");
+	}
+	const auto sv = fsv::filtered_string_view{text, no_stars};
+	for (const auto *delim : {"aab", "aaaaab", "ab", "aba"}) {
+		const auto tok = fsv::filtered_string_view{delim};
+		REQUIRE(strings(fsv::split_view{sv, tok}) == strings(fsv::split(sv, tok)));
+	}
+}
+
+TEST_CASE("split_view tokens point into the original data") {
+	auto no_stars = [](const char &c){ return c != '*'; };
+	const auto sv = fsv::filtered_string_view{"*ab,* cd*", no_stars};
+	auto tokens = fsv::split_view{sv, fsv::filtered_string_view{", "}};
+	auto it = tokens.begin();
+	REQUIRE((*it).data() == sv.data() + 1);
+	REQUIRE((*it).raw_size() == 2);
+	++it;
+	REQUIRE(static_cast<std::string>(*it) == "cd");
+	REQUIRE((*it).data() == sv.data() + 6);
+	REQUIRE(++it == tokens.end());
+}
+
+TEST_CASE("split_view works with ranges algorithms") {
+	const auto record = std::string{"2024-01-01, GET, /index.html, 200, 512"};
+	auto fields = fsv::split_view{fsv::filtered_string_view{record}, fsv::filtered_string_view{", "}};
+
+	REQUIRE(std::ranges::distance(fields) == 5);
+	REQUIRE(static_cast<std::string>(fields.front()) == "2024-01-01");
+	REQUIRE(static_cast<std::string>(*std::ranges::next(fields.begin(), 2)) == "/index.html");
+
+	auto firsts = std::string{};
+	for (const auto &field : fields | std::views::take(2)) {
+		firsts += static_cast<std::string>(field);
+	}
+	REQUIRE(firsts == "2024-01-01GET");
+
+	auto found = std::ranges::find(fields, fsv::filtered_string_view{"200"});
+	REQUIRE(found != fields.end());
+	REQUIRE(static_cast<std::string>(*++found) == "512");
+}
@@ -0,0 +1,47 @@
+#include "./stats.h"
+
+#include <ostream>
+
+namespace fsv::stats {
+	auto api_name(api a) noexcept -> std::string_view {
+		switch (a) {
+		case api::other: return "other";
+		case api::at: return "at";
+		case api::size: return "size";
+		case api::empty: return "empty";
+		case api::to_string: return "to_string";
+		case api::iterate: return "iterate";
+		case api::compare: return "compare";
+		case api::write: return "write";
+		case api::split: return "split";
+		case api::substr: return "substr";
+		case api::compose: return "compose";
+		case api::tabulate: return "tabulate";
+		case api::runs: return "runs";
+		}
+		return "unknown";
+	}
+
+	auto snapshot() noexcept -> snapshot_type {
+		return detail::state.per_api;
+	}
+
+	auto of(api a) noexcept -> counters {
+		return detail::state.per_api[static_cast<std::size_t>(a)];
+	}
+
+	auto reset() noexcept -> void {
+		detail::state.per_api = snapshot_type{};
+	}
+
+	auto dump(std::ostream &os) -> void {
+		for (std::size_t i = 0; i < api_count; ++i) {
+			const auto &c = detail::state.per_api[i];
+			if (c == counters{}) {
+				continue;
+			}
+			os << api_name(static_cast<api>(i)) << " calls=" << c.calls << " predicate_calls=" << c.predicate_calls
+			   << " bytes_scanned=" << c.bytes_scanned << " allocations=" << c.allocations << '\n';
+		}
+	}
+}
@@ -0,0 +1,181 @@
+#ifndef COMP6771_ASS2_STATS_H
+#define COMP6771_ASS2_STATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <type_traits>
+
+// Opt-in instrumentation of the public API.
+// Building with FSV_ENABLE_STATS defined makes every view operation record, in thread-local
+// counters, how often it was called and how many predicate calls, bytes scanned and heap
+// allocations it caused. Work done inside another API call is charged to the outermost one,
+// so e.g. the size() that substr() needs shows up under substr.
+// Work fsv::par hands to its pool's threads is charged to the call on the calling thread.
+// Without FSV_ENABLE_STATS the hooks compile to nothing.
+// The hooks sit in inline and template code, so every translation unit of a program, the
+// library included, must be built with the same setting; configure with
+// -DFSV_ENABLE_STATS=ON to have CMake define it for the library and all its users.
+namespace fsv::stats {
+#ifdef FSV_ENABLE_STATS
+	inline constexpr bool enabled = true;
+#else
+	inline constexpr bool enabled = false;
+#endif
+
+	enum class api { other, at, size, empty, to_string, iterate, compare, write, split, substr, compose, tabulate, runs };
+
+	inline constexpr std::size_t api_count = 13;
+
+	struct counters {
+		std::uint64_t calls = 0;
+		std::uint64_t predicate_calls = 0;
+		// bytes looked at, by the predicate or by the kernels
+		std::uint64_t bytes_scanned = 0;
+		std::uint64_t allocations = 0;
+
+		friend auto operator==(const counters &, const counters &) -> bool = default;
+	};
+
+	using snapshot_type = std::array<counters, api_count>;
+
+	[[nodiscard]] auto api_name(api a) noexcept -> std::string_view;
+
+	// the calling thread's counters, indexed by api
+	[[nodiscard]] auto snapshot() noexcept -> snapshot_type;
+	[[nodiscard]] auto of(api a) noexcept -> counters;
+	auto reset() noexcept -> void;
+	// one line per api with any calls, e.g. "size calls=3 predicate_calls=0 bytes_scanned=96 allocations=0"
+	auto dump(std::ostream &os) -> void;
+
+	namespace detail {
+		struct thread_state {
+			snapshot_type per_api{};
+			api current = api::other;
+			bool in_call = false;
+		};
+
+		inline thread_local thread_state state;
+
+		inline auto current() noexcept -> counters & {
+			return state.per_api[static_cast<std::size_t>(state.current)];
+		}
+
+		// Charges the work of one public call to a; nested calls are charged to their caller.
+		// A literal type so that it can sit in constexpr functions; it does nothing there.
+		class scope {
+		 public:
+			constexpr explicit scope(api a) noexcept {
+				if (!std::is_constant_evaluated() && !state.in_call) {
+					outermost_ = true;
+					state.in_call = true;
+					state.current = a;
+					++current().calls;
+				}
+			}
+			scope(const scope &) = delete;
+			auto operator=(const scope &) -> scope & = delete;
+			constexpr ~scope() {
+				if (outermost_) {
+					state.in_call = false;
+					state.current = api::other;
+				}
+			}
+
+		 private:
+			bool outermost_ = false;
+		};
+	}
+
+	// The hooks below do nothing unless FSV_ENABLE_STATS is defined, and nothing during constant
+	// evaluation.
+	constexpr auto note_predicate_call() noexcept -> void {
+		if constexpr (enabled) {
+			if (!std::is_constant_evaluated()) {
+				++detail::current().predicate_calls;
+				++detail::current().bytes_scanned;
+			}
+		}
+	}
+
+	constexpr auto note_bytes_scanned(std::size_t n) noexcept -> void {
+		if constexpr (enabled) {
+			if (!std::is_constant_evaluated()) {
+				detail::current().bytes_scanned += n;
+			}
+		}
+	}
+
+	constexpr auto note_allocation() noexcept -> void {
+		if constexpr (enabled) {
+			if (!std::is_constant_evaluated()) {
+				++detail::current().allocations;
+			}
+		}
+	}
+
+	namespace detail {
+		// Work this thread does on behalf of another thread's API call, as fsv::par's workers do.
+		// While the scope lives the work is charged to that call's api a; take() then moves it
+		// out of this thread's counters so that the caller can add it to its own (add_to_current).
+		class lent_scope {
+		 public:
+			explicit lent_scope(api a) noexcept : saved_{state.current}, saved_in_call_{state.in_call} {
+				state.current = a;
+				state.in_call = true;
+				before_ = current();
+			}
+			lent_scope(const lent_scope &) = delete;
+			auto operator=(const lent_scope &) -> lent_scope & = delete;
+			~lent_scope() {
+				state.current = saved_;
+				state.in_call = saved_in_call_;
+			}
+
+			// the work done since construction or the last take(); calls are left to the caller
+			[[nodiscard]] auto take() noexcept -> counters {
+				auto &now_ = current();
+				const auto res_ = counters{0, now_.predicate_calls - before_.predicate_calls,
+				                           now_.bytes_scanned - before_.bytes_scanned, now_.allocations - before_.allocations};
+				now_ = before_;
+				return res_;
+			}
+
+		 private:
+			api saved_;
+			bool saved_in_call_;
+			counters before_;
+		};
+
+		inline auto add_to_current(const counters &c) noexcept -> void {
+			auto &now_ = current();
+			now_.calls += c.calls;
+			now_.predicate_calls += c.predicate_calls;
+			now_.bytes_scanned += c.bytes_scanned;
+			now_.allocations += c.allocations;
+		}
+
+		// wraps a predicate so each call is counted
+		template<typename Pred>
+		struct counted {
+			template<typename CharT>
+			constexpr auto operator()(const CharT &c) const -> bool {
+				note_predicate_call();
+				return static_cast<bool>(pred(c));
+			}
+
+			const Pred &pred;
+		};
+	}
+}
+
+// Marks the enclosing function as the public API call a.
+#ifdef FSV_ENABLE_STATS
+#define FSV_STATS_SCOPE(a) const ::fsv::stats::detail::scope fsv_stats_scope_{::fsv::stats::api::a}
+#else
+#define FSV_STATS_SCOPE(a) static_cast<void>(0)
+#endif
+
+#endif // COMP6771_ASS2_STATS_H
@@ -0,0 +1,142 @@
+// Built with FSV_ENABLE_STATS defined, against its own copy of the library.
+#include "./filtered_string_view.h"
+#include "./parallel.h"
+#include "./split_view.h"
+#include "./stats.h"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("stats are compiled in") {
+	STATIC_REQUIRE(fsv::stats::enabled);
+}
+
+TEST_CASE("predicate calls are charged to the outermost api call") {
+	const auto s = std::string{"a,b,c,d"};
+	const auto sv = fsv::filtered_string_view{s, [](const char &c){ return c != ','; }};
+	fsv::stats::reset();
+
+	REQUIRE(sv.size() == 4);
+	auto size = fsv::stats::of(fsv::stats::api::size);
+	REQUIRE(size.calls == 1);
+	REQUIRE(size.predicate_calls == s.size());
+	REQUIRE(size.bytes_scanned == s.size());
+	REQUIRE(size.allocations == 0);
+
+	// substr calls size() internally, which is charged to substr
+	auto sub = fsv::substr(sv, 1, 2);
+	REQUIRE(fsv::stats::of(fsv::stats::api::size).calls == 1);
+	REQUIRE(fsv::stats::of(fsv::stats::api::substr).calls == 1);
+	REQUIRE(fsv::stats::of(fsv::stats::api::substr).predicate_calls > s.size());
+	REQUIRE(sub.raw_size() == 3);
+
+	REQUIRE(sv.at(3) == 'd');
+	REQUIRE(fsv::stats::of(fsv::stats::api::at).predicate_calls == s.size());
+}
+
+TEST_CASE("table predicates scan bytes without predicate calls") {
+	const auto s = std::string(1000, 'x') + ",";
+	const auto sv = fsv::tabulate(fsv::filtered_string_view{s, [](const char &c){ return c != ','; }});
+	REQUIRE(fsv::stats::of(fsv::stats::api::tabulate).predicate_calls == 256);
+	REQUIRE(fsv::stats::of(fsv::stats::api::tabulate).allocations == 1);
+	fsv::stats::reset();
+
+	REQUIRE(sv.size() == 1000);
+	REQUIRE(fsv::stats::of(fsv::stats::api::size).predicate_calls == 0);
+	REQUIRE(fsv::stats::of(fsv::stats::api::size).bytes_scanned == s.size());
+
+	REQUIRE(static_cast<std::string>(sv).size() == 1000);
+	REQUIRE(fsv::stats::of(fsv::stats::api::to_string).allocations == 1);
+}
+
+TEST_CASE("iteration, comparison and split are counted") {
+	const auto s = std::string{"x, y, z"};
+	const auto sv = fsv::filtered_string_view{s, [](const char &c){ return c != ' '; }};
+	fsv::stats::reset();
+
+	auto n = 0;
+	for (auto it = sv.begin(); it != sv.end(); ++it) {
+		++n;
+	}
+	REQUIRE(n == 5);
+	REQUIRE(fsv::stats::of(fsv::stats::api::iterate).predicate_calls == s.size());
+
+	REQUIRE(sv == fsv::filtered_string_view{"x,y,z"});
+	REQUIRE(fsv::stats::of(fsv::stats::api::compare).calls == 1);
+
+	const auto tokens = fsv::split(sv, fsv::filtered_string_view{","});
+	REQUIRE(tokens.size() == 3);
+	REQUIRE(fsv::stats::of(fsv::stats::api::split).calls == 1);
+	REQUIRE(fsv::stats::of(fsv::stats::api::split).allocations >= 1);
+
+	auto os = std::ostringstream{};
+	fsv::stats::dump(os);
+	REQUIRE(os.str().find("split calls=1 ") != std::string::npos);
+	REQUIRE(os.str().find("at ") == std::string::npos);
+}
+
+TEST_CASE("split_view allocates only for long delimiters") {
+	const auto records = std::vector<std::string>{"a, bb, c", "dd, e", "f"};
+	const auto tok = fsv::filtered_string_view{", "};
+	const auto allocations = [] {
+		auto res = std::uint64_t{0};
+		for (const auto &c : fsv::stats::snapshot()) {
+			res += c.allocations;
+		}
+		return res;
+	};
+	fsv::stats::reset();
+
+	auto fields = std::string{};
+	for (const auto &record : records) {
+		for (const auto &field : fsv::split_view{fsv::filtered_string_view{record}, tok}) {
+			fields += *field.data();
+		}
+	}
+	REQUIRE(fields == "abcdef");
+	REQUIRE(fsv::stats::of(fsv::stats::api::split).calls == records.size());
+	REQUIRE(allocations() == 0);
+
+	const auto long_tok = fsv::filtered_string_view{std::string(fsv::split_view<char, fsv::filter, fsv::filter>::inline_delim + 1, '-')};
+	fsv::stats::reset();
+	REQUIRE(std::ranges::distance(fsv::split_view{fsv::filtered_string_view{records[0]}, long_tok}) == 1);
+	REQUIRE(allocations() == 2);
+}
+
+TEST_CASE("stats are per thread") {
+	fsv::stats::reset();
+	const auto s = std::string{"abc"};
+	REQUIRE(fsv::filtered_string_view{s}.size() == 3);
+	auto other = fsv::stats::snapshot_type{};
+	auto t = std::thread([&other] { other = fsv::stats::snapshot(); });
+	t.join();
+	REQUIRE(other == fsv::stats::snapshot_type{});
+	REQUIRE(fsv::stats::of(fsv::stats::api::size).calls == 1);
+}
+
+TEST_CASE("work on fsv::par's pool is charged to the calling thread") {
+	auto pool = fsv::par::thread_pool{4};
+	const auto s = std::string(std::size_t{1} << 21, 'x');
+	const auto sv = fsv::filtered_string_view{s, [](const char &c){ return c != ','; }};
+	fsv::stats::reset();
+
+	REQUIRE(fsv::par::size(sv, pool) == s.size());
+	const auto size = fsv::stats::of(fsv::stats::api::size);
+	REQUIRE(size.calls == 1);
+	REQUIRE(size.predicate_calls == s.size());
+	REQUIRE(size.bytes_scanned == s.size());
+
+	const auto table = fsv::tabulate(sv);
+	REQUIRE(fsv::par::to_string(table, pool).size() == s.size());
+	REQUIRE(fsv::stats::of(fsv::stats::api::to_string).calls == 1);
+	REQUIRE(fsv::stats::of(fsv::stats::api::to_string).bytes_scanned >= 2 * s.size());
+
+	REQUIRE(fsv::par::split(sv, ",", pool).size() == 1);
+	REQUIRE(fsv::stats::of(fsv::stats::api::split).calls == 1);
+	REQUIRE(fsv::stats::of(fsv::stats::api::split).predicate_calls >= s.size());
+}